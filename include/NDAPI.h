@@ -29,6 +29,12 @@
 
 #include <string.h>
 #include <API.h>
+#include <pid.h>
+#include <profile.h>
+#include <thermal.h>
+#include <linear.h>
+#include <filter.h>
+#include <edge.h>
 
 // ------------------------------------------ Ports --------------------------------------------
 
@@ -87,6 +93,7 @@ struct{
 	int port;				//the port the motor is assigned to
 	int velocity;		//the current velocity of the motor
 	bool reversed;	//flag for if the motor is reversed or not
+	int type;				//the type of motor, used to linearise its response
 } typedef Motor;
 
 //motor system data structure
@@ -94,6 +101,7 @@ struct{
 	Motor* motors;			//motors that are part of the system
 	int size;						//number of motors part of the motor system
 	int velocity;				//the current velocity of the motor system
+	LinearTable* table;	//calibrated linearisation table of the motors (NULL for each motor's type table)
 } typedef MotorSystem;
 
 //sensor data structure
@@ -104,20 +112,27 @@ struct{
 	int size;				//the number of ports the sensor uses
 	bool opposite;	//flag for returning opposite values
 	bool analog;		//a flag to determine if the sensor is digital or analog
+	int id;					//the sampler slot of the sensor (-1 if it is not sampled)
 } typedef Sensor;
 
 //sensor system data structure
 struct{
 	Sensor* sensors;			//sensors that are part of the system
 	int size;							//the amount of sensors in the system
+	int policy;						//how the sensor values are combined into one value
+	int* weights;					//weight of each sensor (NULL for equal weights)
 } typedef SensorSystem;
 
+#define LCD_WIDTH 16	//number of characters on a line of the lcd
+#define LCD_LINES 2		//number of lines on the lcd
+
 //lcd data structure
 struct{
-	FILE* port;			//the port that the lcd is using
-	char line1[16];	//the string of characters on the first line of the lcd
-	char line2[16];	//the string of characters on the second line of the lcd
-	bool backLight;	//the state of the lcd back light
+	FILE* port;															//the port that the lcd is using
+	char lines[LCD_LINES][LCD_WIDTH + 1];		//framebuffer of the text written to each line of the lcd
+	char shown[LCD_LINES][LCD_WIDTH + 1];		//text last sent to each line of the lcd
+	volatile bool dirty[LCD_LINES];					//flag for each line changing since it was flushed
+	bool backLight;													//the state of the lcd back light
 }typedef LCD;
 
 // ---------------------------------------- Motor ----------------------------------------------
@@ -128,22 +143,26 @@ void motor_setVelocity(Motor* target, int velocity);										//set the velocity
 int motor_getPort(Motor target);																				//retrieve the port of the motor
 int motor_getVelocity(Motor target);																		//retrieve the velocity of the motor
 bool motor_isReversed(Motor target);																		//retrieve the reversed flag of the motor
+void motor_setType(Motor* target, int type);														//set the type of the motor
+int motor_getType(Motor target);																				//retrieve the type of the motor
 void motor_stop(Motor* target);																					//set the velocity of the motor to zero
 void motor_setFor(Motor* target, int velocity, unsigned int time);			//run motor for a certain amount of time
 void motor_setTill(Motor* target, Sensor* obs, int velocity, int val);	//run motor until a target sensor value has been reached
-void motor_setTillPID(Motor* target, Sensor* obs, double k, int val);		//run motor until a target sensor value has been reached with PID
+void motor_setTillPID(Motor* target, Sensor* obs, PID* pid, int val);		//run motor until a target sensor value has been reached with PID
 
 // ------------------------------------ Motor System -------------------------------------------
 
 bool motorSystem_contains(MotorSystem target, Motor m);															//check to see if the motor system contains the motor
-MotorSystem motorSystem_init(const int motors, Motor* m, ...);											//assign the motors to the motor system
+MotorSystem motorSystem_init(const int motors, Motor* m, ...);											//assign the motors to the motor system, empty if the pool ran out
 void motorSystem_setVelocity(MotorSystem* target, int velocity);										//set the velocity of the motor system
 int motorSystem_getVelocity(MotorSystem target);																		//retrieve the velocity of the motor system
 int motorSystem_getSize(MotorSystem target);																				//retrieve the size of the motor system
 void motorSystem_stop(MotorSystem* target);																					//set the velocity of the motor system to zero
 void motorSystem_setFor(MotorSystem* target, int velocity, unsigned int time);			//run the motor system for a desired amount of time
 void motorSystem_setTill(MotorSystem* target, Sensor* obs, int velocity, int val);	//run the motor system until the target sensor value has been reached
-void motorSystem_setTillPID(MotorSystem* target, Sensor* obs, double k, int val);		//run motor system until a target sensor value has been reached with PID
+void motorSystem_setTillPID(MotorSystem* target, Sensor* obs, PID* pid, int val);		//run motor system until a target sensor value has been reached with PID
+void motorSystem_followProfile(MotorSystem* target, Sensor* obs, PID* pid, Profile* profile);	//run motor system along a motion profile with PID
+bool motorSystem_calibrate(MotorSystem* target, Sensor* obs);												//measure the motor response and build the system its own linearisation table
 void motorSystem_free(MotorSystem* target);																					//free dynamic memmory of motor system
 // ---------------------------------------- Sensor ---------------------------------------------
 
@@ -165,6 +184,11 @@ void motorSystem_free(MotorSystem* target);																					//free dynamic m
 #define LED   10 //LED indicator
 #define SOL   11 //electronic pneumatic solenoid
 
+//sensor flags
+#define EDGES  0x100						//capture the edges of a BUMP or LIM sensor with interrupts (e.g. LIM | EDGES)
+#define HIRES  0x200						//calibrate a POT, LINE or LIGHT sensor and read it at 16 times the resolution
+#define SENSOR_FLAGS (EDGES | HIRES)	//every sensor flag
+
 Sensor sensor_init(int sensorType, const int port, ...);	//initialize the sensor
 void sensor_set(Sensor* target, int value);								//set the value of the sensor
 void sensor_reset(Sensor* target);												//reset sensor
@@ -173,17 +197,35 @@ bool sensor_isOpposite(Sensor target);										//return if the sensor has been
 int sensor_getType(Sensor target);												//retrieve the type of the sensor
 int sensor_getSize(Sensor target);												//retrieve the number of ports the sensor uses
 int sensor_getValue(Sensor target);												//retrieve the current sensor value
+int sensor_getVelocity(Sensor target);										//retrieve the velocity of an encoder
+int sensor_getAcceleration(Sensor target);								//retrieve the acceleration of an encoder
+unsigned int sensor_getEdges(Sensor target);							//retrieve the number of captured edges of a digital input
+bool sensor_popEdge(Sensor target, Edge* edge);						//take the oldest captured edge of a digital input
+unsigned long sensor_getAge(Sensor target);								//retrieve the age of the sensor value in milliseconds
+bool sensor_isHealthy(Sensor target);											//check if the sensor is healthy
+unsigned int sensor_getFaults(Sensor target);							//retrieve the number of faults of the sensor
 bool sensor_isAnalog(Sensor target);											//see if the sensor is digital or analog
+bool sensor_setFilter(Sensor* target, const Filter* filter);	//set the filter run on every sample of the sensor
 void sensor_free(Sensor* target);													//free dynamic memmory of sensor
 
 // ------------------------------------- Sensor System -----------------------------------------
 
+//aggregation policies
+#define SYSTEM_MEAN     0			//mean of the sensor values
+#define SYSTEM_WEIGHTED 1			//mean of the sensor values weighted by sensorSystem_setWeight
+#define SYSTEM_MEDIAN   2			//median of the sensor values
+#define SYSTEM_HEALTHY  0x100	//leave out unhealthy sensors (e.g. SYSTEM_MEAN | SYSTEM_HEALTHY)
+
 bool sensorSystem_contains(SensorSystem target, Sensor sensor);						//check to see if the sensor system contains the sensor
 SensorSystem sensorSystem_init(const int sensors, Sensor* sensor, ...);		//initialize the sensor system
 void sensorSystem_set(SensorSystem* target, int value);										//set the value of the sensor system
 void sensorSystem_reset(SensorSystem* target);														//reset sensor system
 int sensorSystem_getSize(SensorSystem target);														//retrieve the number of ports the sensor uses
-int sensorSystem_getValue(SensorSystem target);														//retrieve the average current sensor value
+int sensorSystem_getValue(SensorSystem target);														//retrieve the combined current sensor value
+void sensorSystem_setPolicy(SensorSystem* target, int policy);							//set how the sensor values are combined
+int sensorSystem_getPolicy(SensorSystem target);													//retrieve how the sensor values are combined
+bool sensorSystem_setWeight(SensorSystem* target, int index, int weight);	//set the weight of a sensor in the system
+int sensorSystem_getHealthy(SensorSystem target);													//retrieve the number of healthy sensors
 void sensorSystem_free(SensorSystem* target);															//free dynamic memmory of sensor system
 
 // ------------------------------------------ LCD ----------------------------------------------
@@ -193,6 +235,8 @@ void sensorSystem_free(SensorSystem* target);															//free dynamic memmo
 #define TOP    1			//first line of lcd
 #define BOTTOM 2			//second line of lcd
 
+#define LCD_PERIOD 50	//default flush period in milliseconds, bounds the serial traffic to the lcd
+
 LCD lcd_init(FILE* port);																																//initialize the lcd
 FILE* lcd_getPort(LCD lcd);																															//return the port the lcd is using
 char* lcd_getLine(LCD* lcd, unsigned char line);																				//return the first line that is written on the lcd
@@ -204,7 +248,61 @@ void lcd_centerPrint(LCD* lcd, unsigned char line, const char* buffer);
 int lcd_buttonPressed(LCD lcd);																													//get the current button being pressed
 bool lcd_buttonIsPressed(LCD lcd, int btn);																							//return true if the target button is being pressed
 void lcd_waitForRelease(LCD lcd);																												//wait for the button to be released
+int lcd_getPress(const LCD* lcd);																												//take the next press of a button
 bool lcd_backLightIsOn(LCD lcd);																												//return state of the lcd backlight
 void lcd_backLight(LCD* lcd, bool state);																								//change state of lcd backlight
+int lcd_flush(LCD* lcd);																																//send the lines that have changed to the lcd
+void lcd_start(LCD* lcd, unsigned long period);																					//flush the lcd in the background
+void lcd_stop();																																				//stop flushing the lcd in the background
+
+// -------------------------------- Const Pointer Accessors ------------------------------------
+
+/*
+ * The accessors below take their data structure by const pointer, so
+ * nothing is copied onto the stack, and the simple ones are defined
+ * here so they inline into control loops. The functions above that
+ * take a data structure by value are kept and call these.
+ */
+
+bool motorSystem_containsRef(const MotorSystem* target, const Motor* m);	//check to see if the motor system contains the motor
+int sensor_getValueRef(const Sensor* target);															//retrieve the current sensor value
+int sensor_readRef(const Sensor* target);																	//read the sensor value from the hardware
+int sensor_getVelocityRef(const Sensor* target);														//retrieve the velocity of an encoder
+int sensor_getAccelerationRef(const Sensor* target);												//retrieve the acceleration of an encoder
+unsigned int sensor_getEdgesRef(const Sensor* target);											//retrieve the number of captured edges of a digital input
+bool sensor_popEdgeRef(const Sensor* target, Edge* edge);										//take the oldest captured edge of a digital input
+unsigned long sensor_getAgeRef(const Sensor* target);											//retrieve the age of the sensor value in milliseconds
+bool sensor_isHealthyRef(const Sensor* target);														//check if the sensor is healthy
+unsigned int sensor_getFaultsRef(const Sensor* target);											//retrieve the number of faults of the sensor
+bool sensorSystem_containsRef(const SensorSystem* target, const Sensor* sensor);	//check to see if the sensor system contains the sensor
+int sensorSystem_getValueRef(const SensorSystem* target);									//retrieve the combined current sensor value
+int sensorSystem_getHealthyRef(const SensorSystem* target);								//retrieve the number of healthy sensors
+int lcd_buttonPressedRef(const LCD* lcd);																	//get the current button being pressed
+bool lcd_buttonIsPressedRef(const LCD* lcd, int btn);											//return true if the target button is being pressed
+void lcd_waitForReleaseRef(const LCD* lcd);																//wait for the button to be released
+
+//motor
+static inline int motor_getPortRef(const Motor* target){return target->port;}
+static inline int motor_getVelocityRef(const Motor* target){return target->velocity;}
+static inline bool motor_isReversedRef(const Motor* target){return target->reversed;}
+static inline int motor_getTypeRef(const Motor* target){return target->type;}
+
+//motor system
+static inline int motorSystem_getVelocityRef(const MotorSystem* target){return target->velocity;}
+static inline int motorSystem_getSizeRef(const MotorSystem* target){return target->size;}
+
+//sensor
+static inline bool sensor_isOppositeRef(const Sensor* target){return target->opposite;}
+static inline int sensor_getTypeRef(const Sensor* target){return target->type;}
+static inline int sensor_getSizeRef(const Sensor* target){return target->size;}
+static inline bool sensor_isAnalogRef(const Sensor* target){return target->analog;}
+
+//sensor system
+static inline int sensorSystem_getSizeRef(const SensorSystem* target){return target->size;}
+static inline int sensorSystem_getPolicyRef(const SensorSystem* target){return target->policy;}
+
+//lcd
+static inline FILE* lcd_getPortRef(const LCD* lcd){return lcd->port;}
+static inline bool lcd_backLightIsOnRef(const LCD* lcd){return lcd->backLight;}
 
 #endif /* NDAPI_H_ */
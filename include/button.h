@@ -0,0 +1,60 @@
+/*
+ * @file button.h
+ *
+ * @brief Debounced lcd buttons. The button task samples the buttons of
+ *		  an lcd at a fixed rate, only accepts a change once it has held
+ *		  for several samples, and queues a timestamped event for each
+ *		  press, release and long press. Checking a button is then a read
+ *		  of the debounced state or the queue instead of a delay and a
+ *		  read of the lcd.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BUTTON_H_
+#define BUTTON_H_
+
+#include <API.h>
+
+#define BUTTON_PERIOD   10		//default sample period in milliseconds
+#define BUTTON_DEBOUNCE 3			//samples a button must hold a new state for before it is accepted
+#define BUTTON_HOLD     1000	//time in milliseconds a button is held for a long press
+#define BUTTON_EVENTS   16		//number of events the queue holds, must be a power of two
+#define BUTTON_COUNT    3			//number of buttons on the lcd
+
+//button event types
+#define BUTTON_PRESS   0	//button was pressed
+#define BUTTON_RELEASE 1	//button was released
+#define BUTTON_LONG    2	//button has been held for BUTTON_HOLD
+
+//button event
+struct{
+	unsigned char button;		//LCD_BTN_LEFT, LCD_BTN_CENTER or LCD_BTN_RIGHT
+	unsigned char type;			//BUTTON_PRESS, BUTTON_RELEASE or BUTTON_LONG
+	unsigned long stamp;		//time of the event in milliseconds
+} typedef ButtonEvent;
+
+void button_start(FILE* port, unsigned long period);	//sample the buttons of an lcd in the button task
+void button_stop();																		//stop the button task
+void button_step();																		//sample the buttons and queue any events
+FILE* button_getPort();																//retrieve the port of the lcd being sampled
+unsigned int button_getState();												//retrieve the debounced buttons being held
+bool button_isPressed(int btn);												//check if a button is held
+bool button_pop(ButtonEvent* event);									//take the oldest event
+int button_getPress();																//take the next press
+void button_flush();																	//discard every event
+
+#endif /* BUTTON_H_ */
@@ -0,0 +1,53 @@
+/*
+ * @file dio.h
+ *
+ * @brief Digital I/O held as 12 bit words, with bit zero for pin one.
+ *		  The direction of each pin is tracked as it is set up, so every
+ *		  pin but the outputs is read into the input word once per tick
+ *		  and only the output bits that have changed are written to the
+ *		  hardware.
+ *		  Sensors, recording and replay share the words instead of each
+ *		  reading and writing every pin themselves.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DIO_H_
+#define DIO_H_
+
+#include <API.h>
+
+#define DIO_PINS 12			//number of digital pins
+#define DIO_ALL  0x0FFF	//bit of every digital pin
+
+#define DIO_BIT(pin) (1u << ((pin) - 1))	//bit of a digital pin in a word
+
+void dio_setMode(unsigned char pin, unsigned char mode);		//set up a pin and track its direction
+unsigned int dio_getOutputPins();														//retrieve the bits of the output pins
+unsigned int dio_getInputPins();														//retrieve the bits of the input pins
+unsigned int dio_sample();																	//read every pin but the outputs into the input word
+unsigned int dio_getInputs();																//retrieve the input word from the last sample
+bool dio_get(unsigned char pin);														//retrieve the level of a pin from the words
+void dio_set(unsigned char pin, bool level);								//set the level of an output pin without writing it
+void dio_setOutputs(unsigned int word, unsigned int mask);	//set the levels of several output pins without writing them
+unsigned int dio_getOutputs();															//retrieve the output word
+int dio_flush();																						//write the output pins that have changed
+void dio_write(unsigned char pin, bool level);							//set the level of a pin and write it
+unsigned int dio_getState();																//retrieve the level of every pin as one word
+unsigned long dio_getReads();																//retrieve the number of pin reads
+unsigned long dio_getWrites();															//retrieve the number of pin writes
+
+#endif /* DIO_H_ */
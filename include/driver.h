@@ -0,0 +1,48 @@
+/*
+ * @file driver.h
+ *
+ * @brief Sensor driver data structure and prototypes. Each sensor type
+ *		  has a driver holding the functions that initialize, read, reset
+ *		  and shut down that kind of sensor, looked up by type in a table.
+ *		  The built in types have drivers already, and new kinds of sensor
+ *		  can be added by registering a driver for an unused type.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DRIVER_H_
+#define DRIVER_H_
+
+#include <stdarg.h>
+#include <NDAPI.h>
+
+#define DRIVER_TYPES 16	//number of sensor types the table holds
+
+//sensor driver data structure
+struct{
+	int size;																						//number of ports the sensor uses
+	void (*init)(Sensor* target, int flags, va_list* param);	//set up the sensor once its ports are assigned
+	bool (*read)(const Sensor* target, int* value);			//read the sensor value from the hardware, returning if it succeeded
+	void (*reset)(Sensor* target);											//set the sensor value to zero
+	void (*shutdown)(Sensor* target);										//release the hardware used by the sensor
+} typedef SensorDriver;
+
+bool driver_register(int type, const SensorDriver* driver);	//register the driver for a sensor type
+const SensorDriver* driver_get(int type);										//retrieve the driver for a sensor type
+bool driver_isSwept(int type);															//check if a sensor type is read from a sampler sweep
+int driver_getFull(const Sensor* target);										//retrieve the largest value of an analog input that can rail
+
+#endif /* DRIVER_H_ */
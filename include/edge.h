@@ -0,0 +1,56 @@
+/*
+ * @file edge.h
+ *
+ * @brief Interrupt driven edge capture for digital inputs. Each edge on
+ *		  an enabled pin is timestamped by its interrupt handler and pushed
+ *		  into that pin's ring buffer, which a control loop drains, so
+ *		  presses that are shorter than a control loop period are never
+ *		  missed. Each pin's buffer has one producer, the handler, and one
+ *		  consumer, so the buffers need no locks. A task that drains one
+ *		  pin with edge_popPin must not share it with edge_pop, which
+ *		  drains every pin.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EDGE_H_
+#define EDGE_H_
+
+#include <API.h>
+
+#define EDGE_BUFFER 8		//number of edges each pin's buffer holds, must be a power of two
+#define EDGE_PINS   12	//number of digital pins
+
+//digital input edge
+struct{
+	unsigned char pin;			//the pin the edge happened on
+	bool level;							//the level of the pin after the edge
+	unsigned long stamp;		//time of the edge in microseconds
+} typedef Edge;
+
+void edge_enable(unsigned char pin, unsigned char edges);	//capture the edges of a pin
+void edge_disable(unsigned char pin);											//stop capturing the edges of a pin
+bool edge_isEnabled(unsigned char pin);										//check if the edges of a pin are captured
+bool edge_pop(Edge* edge);																//take the oldest edge of any pin
+bool edge_popPin(unsigned char pin, Edge* edge);					//take the oldest edge of a pin
+bool edge_pending();																			//check if any pin has edges in its buffer
+void edge_flush();																				//discard the edges of every pin
+void edge_flushPin(unsigned char pin);										//discard the edges of a pin
+unsigned int edge_getCount(unsigned char pin);						//retrieve the number of edges on a pin
+unsigned long edge_getLast(unsigned char pin);						//retrieve the time of the last edge on a pin
+unsigned int edge_getDropped();														//retrieve the number of edges lost to full buffers
+
+#endif /* EDGE_H_ */
@@ -0,0 +1,71 @@
+/*
+ * @file filter.h
+ *
+ * @brief Sensor filter data structure and prototypes. A filter is a
+ *		  chain of up to FILTER_STAGES stages that each hold a fixed amount
+ *		  of state and use integer math, so they can run on every sample
+ *		  of a sensor without allocating memory or using floating point.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FILTER_H_
+#define FILTER_H_
+
+#include <API.h>
+#include <fixed.h>
+
+#define FILTER_STAGES 4	//maximum number of stages in a filter
+#define FILTER_WINDOW 7	//maximum number of samples averaged or searched for the median
+
+//filter stage types
+#define FILTER_AVERAGE  0	//moving average over a window of samples
+#define FILTER_MEDIAN   1	//median of a window of samples
+#define FILTER_EMA      2	//exponential moving average
+#define FILTER_DEADBAND 3	//ignore changes smaller than a width
+#define FILTER_RATE     4	//limit the change per sample
+
+//filter stage data structure
+struct{
+	int type;										//the type of stage
+	int param;									//window, width or change per sample depending on the type
+	Fixed alpha;								//smoothing factor of an exponential moving average
+	int history[FILTER_WINDOW];	//most recent samples
+	int count;									//number of samples in the history
+	int index;									//position of the next sample in the history
+	int sum;										//sum of the samples in the history
+	int output;									//last output of the stage
+	Fixed fraction;							//fraction of the output carried by an exponential moving average
+	bool primed;								//flag for the stage having an output
+} typedef FilterStage;
+
+//filter data structure
+struct{
+	FilterStage stages[FILTER_STAGES];	//stages in the order they are applied
+	int size;														//number of stages
+} typedef Filter;
+
+Filter filter_init();																//initialize an empty filter
+bool filter_addAverage(Filter* filter, int window);	//add a moving average stage
+bool filter_addMedian(Filter* filter, int window);	//add a median stage
+bool filter_addEMA(Filter* filter, Fixed alpha);		//add an exponential moving average stage
+bool filter_addDeadband(Filter* filter, int width);	//add a deadband stage
+bool filter_addRate(Filter* filter, int rate);			//add a rate limit stage
+void filter_reset(Filter* filter);									//forget every sample
+int filter_apply(Filter* filter, int value);				//run a sample through the filter
+int filter_getSize(Filter* filter);									//retrieve the number of stages
+
+#endif /* FILTER_H_ */
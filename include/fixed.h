@@ -0,0 +1,198 @@
+/*
+ * @file fixed.h
+ *
+ * @brief Q16.16 fixed-point number type with saturating arithmetic.
+ *		  The CORTEX has no floating point unit, so every float or double
+ *		  operation becomes a software library call. Control loop math
+ *		  uses this type instead so that each operation is a handful of
+ *		  integer instructions. The functions are defined in the header
+ *		  so they are inlined into the loops that use them.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FIXED_H_
+#define FIXED_H_
+
+#include <stdint.h>
+
+//Q16.16 fixed-point number
+typedef int32_t Fixed;
+
+#define FIXED_SHIFT 16						//number of fractional bits
+#define FIXED_ONE   (1 << FIXED_SHIFT)	//fixed-point value of one
+#define FIXED_HALF  (1 << (FIXED_SHIFT - 1))	//fixed-point value of one half
+#define FIXED_MAX   INT32_MAX					//largest fixed-point value
+#define FIXED_MIN   INT32_MIN					//smallest fixed-point value
+
+//convert a constant to fixed-point at compile time, for example FIXED(0.7)
+#define FIXED(x) ((Fixed)((x) * FIXED_ONE + ((x) >= 0 ? 0.5 : -0.5)))
+
+/*
+ * Clamp a 64 bit intermediate result into the fixed-point range.
+ *
+ * @param value The value being clamped.
+ * @return The saturated fixed-point value.
+ */
+static inline Fixed fixed_saturate(int64_t value){
+	if(value > FIXED_MAX)
+		return FIXED_MAX;
+	else if(value < FIXED_MIN)
+		return FIXED_MIN;
+	return (Fixed)value;
+}
+
+/*
+ * Convert an integer to fixed-point.
+ *
+ * @param value The integer being converted.
+ * @return The saturated fixed-point value.
+ */
+static inline Fixed fixed_fromInt(int value){
+	return fixed_saturate((int64_t)value << FIXED_SHIFT);
+}
+
+/*
+ * Convert a fixed-point value to an integer, rounding to nearest.
+ *
+ * @param value The fixed-point value being converted.
+ * @return The nearest integer.
+ */
+static inline int fixed_toInt(Fixed value){
+	return (int)(((int64_t)value + FIXED_HALF) >> FIXED_SHIFT);
+}
+
+/*
+ * Convert a double to fixed-point, rounding to nearest. This is a
+ * software floating point operation on the CORTEX, so it is meant for
+ * converting settings once, not for control loops.
+ *
+ * @param value The double being converted.
+ * @return The saturated fixed-point value.
+ */
+static inline Fixed fixed_fromDouble(double value){
+
+	double scaled = value * FIXED_ONE;	//value in fixed-point units
+
+	//out of range
+	if(scaled >= (double)FIXED_MAX)
+		return FIXED_MAX;
+	else if(scaled <= (double)FIXED_MIN)
+		return FIXED_MIN;
+
+	return (Fixed)(scaled + (scaled >= 0 ? 0.5 : -0.5));
+}
+
+/*
+ * Convert a fixed-point value to a double. Like fixed_fromDouble this
+ * is meant for settings and reports, not control loops.
+ *
+ * @param value The fixed-point value being converted.
+ * @return The value as a double.
+ */
+static inline double fixed_toDouble(Fixed value){
+	return (double)value / FIXED_ONE;
+}
+
+/*
+ * Add two fixed-point values, saturating on overflow.
+ *
+ * @param a The first value.
+ * @param b The second value.
+ * @return The saturated sum.
+ */
+static inline Fixed fixed_add(Fixed a, Fixed b){
+	return fixed_saturate((int64_t)a + b);
+}
+
+/*
+ * Subtract two fixed-point values, saturating on overflow.
+ *
+ * @param a The first value.
+ * @param b The value being subtracted.
+ * @return The saturated difference.
+ */
+static inline Fixed fixed_sub(Fixed a, Fixed b){
+	return fixed_saturate((int64_t)a - b);
+}
+
+/*
+ * Multiply two fixed-point values, saturating on overflow. On the
+ * CORTEX this is a single long multiply and a shift.
+ *
+ * @param a The first value.
+ * @param b The second value.
+ * @return The saturated product.
+ */
+static inline Fixed fixed_mul(Fixed a, Fixed b){
+	return fixed_saturate(((int64_t)a * b) >> FIXED_SHIFT);
+}
+
+/*
+ * Multiply a fixed-point value by an integer, saturating on overflow.
+ *
+ * @param a The fixed-point value.
+ * @param b The integer.
+ * @return The saturated product.
+ */
+static inline Fixed fixed_mulInt(Fixed a, int b){
+	return fixed_saturate((int64_t)a * b);
+}
+
+/*
+ * Divide two fixed-point values, saturating on overflow and on
+ * division by zero.
+ *
+ * @param a The dividend.
+ * @param b The divisor.
+ * @return The saturated quotient.
+ */
+static inline Fixed fixed_div(Fixed a, Fixed b){
+
+	//division by zero saturates in the direction of the dividend
+	if(b == 0)
+		return a >= 0 ? FIXED_MAX : FIXED_MIN;
+
+	return fixed_saturate(((int64_t)a << FIXED_SHIFT) / b);
+}
+
+/*
+ * Retrieve the absolute value of a fixed-point value.
+ *
+ * @param value The fixed-point value.
+ * @return The saturated absolute value.
+ */
+static inline Fixed fixed_abs(Fixed value){
+	return value < 0 ? fixed_saturate(-(int64_t)value) : value;
+}
+
+/*
+ * Clamp a fixed-point value between two limits.
+ *
+ * @param value The value being clamped.
+ * @param min The lower limit.
+ * @param max The upper limit.
+ * @return The clamped value.
+ */
+static inline Fixed fixed_clamp(Fixed value, Fixed min, Fixed max){
+	if(value > max)
+		return max;
+	else if(value < min)
+		return min;
+	return value;
+}
+
+#endif /* FIXED_H_ */
@@ -0,0 +1,58 @@
+/*
+ * @file heading.h
+ *
+ * @brief Complementary heading estimator data structure and prototypes.
+ *		  The gyro gives the heading over short periods and the drive
+ *		  encoders pull it back slowly so gyro drift does not build up.
+ *		  When the two disagree by more than drift could account for the
+ *		  wheels have slipped, and the encoder heading is moved back onto
+ *		  the fused heading. While the robot is still the gyro bias is
+ *		  learned.
+ *		  Headings are fixed-point degrees, counterclockwise.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HEADING_H_
+#define HEADING_H_
+
+#include <API.h>
+#include <fixed.h>
+
+#define HEADING_GAIN      FIXED(0.004)	//fraction of the encoder disagreement corrected each step
+#define HEADING_SLIP      FIXED(3)			//disagreement in degrees treated as wheel slip
+#define HEADING_STILL     25						//steps without encoder motion before the robot is still
+#define HEADING_BIAS      200						//still steps the gyro drift is averaged over before it is used
+
+//heading estimator data structure
+struct{
+	Fixed heading;		//fused heading
+	Fixed encoder;		//heading from the encoders, kept near the fused heading
+	Fixed bias;				//gyro drift per step
+	int still;				//steps without encoder motion
+	Fixed drift;			//gyro change since the robot became still
+	unsigned int slips;	//number of times the wheels have slipped
+} typedef Heading;
+
+Heading heading_init(Fixed heading);																			//initialize the estimator at a heading
+Fixed heading_update(Heading* target, Fixed gyroTurn, Fixed encoderTurn, bool moving);	//fuse one step of gyro and encoder turn
+void heading_set(Heading* target, Fixed heading);													//set the heading
+Fixed heading_get(Heading* target);																				//retrieve the fused heading
+Fixed heading_getBias(Heading* target);																		//retrieve the gyro drift per step
+bool heading_isStill(Heading* target);																		//check if the robot is still
+unsigned int heading_getSlips(Heading* target);														//retrieve the number of wheel slips
+
+#endif /* HEADING_H_ */
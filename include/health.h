@@ -0,0 +1,71 @@
+/*
+ * @file health.h
+ *
+ * @brief Sensor health monitoring. Every sampler read of a sensor is
+ *		  recorded against its sampler slot, so a sensor that stops
+ *		  returning good reads, an analog input stuck at either end of
+ *		  its range, or an encoder that does not move while a controller
+ *		  drives its mechanism is reported as unhealthy. Controllers
+ *		  check the health of their sensor every sample and stop rather
+ *		  than drive a mechanism blind. Each slot has one writer per
+ *		  part: the sampler task records reads, and the one controller
+ *		  driving the sensor records its watch, so no slot needs a lock.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HEALTH_H_
+#define HEALTH_H_
+
+#include <sampler.h>
+
+#define HEALTH_TIMEOUT 250		//time in ms without a good read before a sensor is stale
+#define HEALTH_STUCK   1000	//time in ms an analog input may sit unchanged at a rail
+#define HEALTH_RAIL    2			//distance from either end of the range treated as a rail
+#define HEALTH_STALL   500		//time in ms a driven sensor may stay still before it is dead
+#define HEALTH_DRIVE   60			//controller output treated as driving the mechanism
+
+//sensor health data structure
+struct{
+	bool seen;							//flag for the sensor having had a good read
+	unsigned long lastGood;	//time of the last good read in ms
+	int value;							//value of the last good read
+	unsigned int errors;		//number of failed reads
+	unsigned long railed;		//time the value settled at a rail in ms, 0 if it is not at one
+	bool stuck;							//flag for the value being stuck at a rail
+	unsigned int stucks;		//number of times the value has stuck
+	int watched;						//value when the sensor was last seen moving under drive
+	unsigned long moved;		//time the sensor was last seen moving under drive in ms
+	bool stalled;						//flag for the sensor not moving under drive
+	unsigned int stalls;		//number of times the sensor has stalled
+} typedef Health;
+
+void health_reset(int id);													//forget the health of a sensor
+int health_update(int id, bool good, int value, int full);	//record a read, returning the value to use
+bool health_watch(int id, int value, int output);		//check a sensor is moving while a controller drives it
+void health_rearm(int id);													//clear a stall before a new controller run
+bool health_isHealthy(int id);											//check if a sensor is healthy
+bool health_isStale(int id);												//check if a sensor has gone without a good read
+bool health_isStuck(int id);												//check if a sensor is stuck at a rail
+bool health_isStalled(int id);											//check if a sensor did not move under drive
+unsigned long health_getLastGood(int id);						//retrieve the time of the last good read
+int health_getValue(int id, int value);							//retrieve the value of the last good read
+unsigned int health_getErrors(int id);							//retrieve the number of failed reads
+unsigned int health_getFaults(int id);							//retrieve the number of faults of every kind
+unsigned int health_getTotalFaults();								//retrieve the number of faults of every sensor
+void health_report(FILE* stream);										//write every sensor's fault counters as a telemetry line
+
+#endif /* HEALTH_H_ */
@@ -0,0 +1,62 @@
+/*
+ * @file ime.h
+ *
+ * @brief IME chain manager. The chain is initialized once, and every
+ *		  IME on it is read in a single sweep per tick, so the I2C
+ *		  latency is paid by the sampler rather than by control code.
+ *		  Counts and velocities are cached along with I2C error and
+ *		  retry counts for telemetry.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef IME_H_
+#define IME_H_
+
+#include <API.h>
+#include <velocity.h>
+
+#define IME_MAX     10	//largest number of IMEs that can be used on one chain
+#define IME_RETRIES 2		//extra attempts to read an IME in a sweep
+
+//cached IME state
+struct{
+	int count;									//last count read
+	Velocity velocity;					//velocity estimated from the counts
+	unsigned long stamp;				//time of the last good read in microseconds
+	bool good;									//flag for the last read succeeding
+	unsigned int resets;				//number of times the IME has been reset
+	unsigned int seen;					//resets the sweep has handled
+	unsigned int errors;				//number of reads that failed after every retry
+	unsigned int retries;				//number of retried reads
+} typedef ImeState;
+
+unsigned int ime_init();												//initialize the IME chain once
+unsigned int ime_reinitialize();								//initialize the IME chain again
+bool ime_isInitialized();												//check if the IME chain has been initialized
+unsigned int ime_getSize();											//retrieve the number of IMEs on the chain
+void ime_sweep();																//read every IME on the chain once
+void ime_reset(unsigned char address);					//reset the count of an IME
+bool ime_getCount(unsigned char address, int* value);	//retrieve the cached count of an IME
+int ime_getVelocity(unsigned char address);			//retrieve the velocity of an IME
+int ime_getAcceleration(unsigned char address);	//retrieve the acceleration of an IME
+unsigned long ime_getStamp(unsigned char address);	//retrieve the time of the last good read of an IME
+unsigned int ime_getErrors(unsigned char address);	//retrieve the number of failed reads of an IME
+unsigned int ime_getRetries(unsigned char address);	//retrieve the number of retried reads of an IME
+unsigned long ime_getSweeps();									//retrieve the number of sweeps
+void ime_report(FILE* stream);									//write the I2C error and retry counts as a telemetry line
+
+#endif /* IME_H_ */
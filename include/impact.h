@@ -0,0 +1,62 @@
+/*
+ * @file impact.h
+ *
+ * @brief Collision and tip detection from a three axis accelerometer.
+ *		  Each axis is read at a fixed rate and split into a slow
+ *		  gravity estimate and the fast acceleration left over. A spike
+ *		  in the magnitude of the fast part is a collision, and the angle
+ *		  of the gravity estimate from its level direction is the tilt.
+ *		  Controllers poll the latched events or register a handler so
+ *		  they can cut their output as soon as the robot hits something.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef IMPACT_H_
+#define IMPACT_H_
+
+#include <NDAPI.h>
+#include <trig.h>
+
+#define IMPACT_PERIOD    5						//default detection period in milliseconds
+#define IMPACT_SCALE     400					//accelerometer counts per g with the jumpers in the 2 g range
+#define IMPACT_TAU       200					//time constant of the gravity estimate in milliseconds
+#define IMPACT_SHOCK     FIXED(0.8)		//fast acceleration in g that is a collision
+#define IMPACT_HOLDOFF   150					//time in ms after a collision before another is reported
+#define IMPACT_TIP       25						//default tilt in degrees that is tipping
+#define IMPACT_RECOVER   5						//degrees below the tip limit the tilt must fall to recover
+#define IMPACT_SAMPLES   50						//readings averaged when calibrating
+
+//impact events
+#define IMPACT_COLLISION 0x1	//the robot hit something
+#define IMPACT_TIPPING   0x2	//the robot tilted past the tip limit
+
+void impact_init(const Sensor* x, const Sensor* y, const Sensor* z, int scale);	//set the accelerometer axes
+void impact_calibrate();											//measure the level readings while the robot is still
+void impact_start(unsigned long period);			//start the detection task
+void impact_stop();														//stop the detection task
+void impact_step();														//read the accelerometer and detect events
+void impact_setHandler(void (*handler)(int event));	//set the function called on each event
+void impact_setTipLimit(int degrees);					//set the tilt that is tipping
+int impact_poll();														//retrieve and clear the events since the last poll
+bool impact_isTipping();											//check if the robot is tilted past the tip limit
+Fixed impact_getShock();											//retrieve the fast acceleration magnitude in g
+Fixed impact_getTilt();												//retrieve the tilt from level in degrees
+unsigned int impact_getCollisions();					//retrieve the number of collisions
+unsigned int impact_getTips();								//retrieve the number of times the robot has tipped
+unsigned long impact_getLastCollision();			//retrieve the time of the last collision
+
+#endif /* IMPACT_H_ */
@@ -0,0 +1,82 @@
+/*
+ * @file line.h
+ *
+ * @brief Line sensor array tracking. Several LINE sensors mounted in a
+ *		  row are sampled at a high rate and each is normalised between
+ *		  the lightest and darkest readings it has seen, so thresholds
+ *		  calibrate themselves as the robot drives over the field. The
+ *		  array reports the weighted centroid of the line under it and
+ *		  a timestamped event each time a sensor reaches or leaves the
+ *		  line, which lets autonomous routines square up on field tape.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LINE_H_
+#define LINE_H_
+
+#include <NDAPI.h>
+
+#define LINE_SENSORS  8			//most sensors in an array
+#define LINE_ARRAYS   2			//most arrays sampled by the line task
+#define LINE_EVENTS   16		//number of events an array holds, must be a power of two
+#define LINE_PERIOD   2			//default sample period in milliseconds
+#define LINE_SPACING  1000	//position units between neighbouring sensors
+#define LINE_FULL     1000	//normalised level of a sensor fully over the line
+#define LINE_ON       600		//normalised level a sensor reaches the line at
+#define LINE_OFF      400		//normalised level a sensor leaves the line at
+#define LINE_FLOOR    150		//normalised level below which a sensor does not count towards the centroid
+#define LINE_CONTRAST 200		//difference between the lightest and darkest readings before a sensor is calibrated
+
+//line edge event
+struct{
+	unsigned char sensor;		//index of the sensor in the array
+	bool on;								//flag for the sensor reaching the line rather than leaving it
+	unsigned long stamp;		//time of the event in microseconds
+} typedef LineEvent;
+
+//line sensor array data structure
+struct{
+	const Sensor* sensors[LINE_SENSORS];	//sensors from left to right
+	int size;															//number of sensors
+	bool dark;														//flag for the line being darker than the floor
+	int lightest[LINE_SENSORS];						//lowest reading of each sensor
+	int darkest[LINE_SENSORS];						//highest reading of each sensor
+	int levels[LINE_SENSORS];							//normalised level of each sensor, LINE_FULL over the line
+	volatile unsigned int on;							//bit of each sensor over the line
+	volatile int position;								//centroid of the line, 0 under the middle and positive to the right
+	volatile bool found;									//flag for any sensor being over the line
+	unsigned long stamps[LINE_SENSORS];		//time each sensor last reached the line in microseconds
+	LineEvent events[LINE_EVENTS];				//edge events
+	volatile unsigned int head;						//number of events pushed
+	volatile unsigned int tail;						//number of events popped
+	unsigned int dropped;									//number of events lost to a full buffer
+} typedef LineArray;
+
+LineArray line_init(int sensors, bool dark, const Sensor* sensor, ...);	//set the sensors of an array from left to right
+void line_calibrate(LineArray* array);													//forget the lightest and darkest readings
+void line_step(LineArray* array);																//sample an array and report edge events
+bool line_start(LineArray* array, unsigned long period);				//sample an array in the line task
+void line_stop();																								//stop the line task
+bool line_isCalibrated(const LineArray* array, int index);			//check if a sensor has seen the line and the floor
+bool line_isFound(const LineArray* array);											//check if any sensor is over the line
+bool line_isOn(const LineArray* array, int index);							//check if a sensor is over the line
+int line_getPosition(const LineArray* array);										//retrieve the centroid of the line
+unsigned long line_getStamp(const LineArray* array, int index);	//retrieve the time a sensor last reached the line
+bool line_pop(LineArray* array, LineEvent* event);							//take the oldest edge event
+void line_flush(LineArray* array);															//discard every edge event
+
+#endif /* LINE_H_ */
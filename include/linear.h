@@ -0,0 +1,60 @@
+/*
+ * @file linear.h
+ *
+ * @brief Motor response linearisation tables. A motor's speed is not
+ *		  proportional to its commanded value: nothing happens inside a
+ *		  deadband and the speed flattens out near full power. Each motor
+ *		  type has a default lookup table that maps a desired proportional
+ *		  speed to the command that produces it, built from a model of the
+ *		  motor response during initialization. A motor system can be
+ *		  given its own table from a calibration run, which only changes
+ *		  the motors of that system.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LINEAR_H_
+#define LINEAR_H_
+
+#include <API.h>
+
+//motor types
+#define MOTOR_393   0	//2-wire motor 393
+#define MOTOR_269   1	//2-wire motor 269
+#define MOTOR_RAW   2	//no linearisation
+#define MOTOR_TYPES 3	//number of motor types
+
+//default response models
+#define LINEAR_393_DEADBAND   12	//largest 393 command that does not move the motor
+#define LINEAR_393_SATURATION 90	//393 command that reaches 90% of full speed
+#define LINEAR_269_DEADBAND   15	//largest 269 command that does not move the motor
+#define LINEAR_269_SATURATION 100	//269 command that reaches 90% of full speed
+
+#define LINEAR_NOISE 10	//percent of the fastest speed a measured speed may drop below a lower command's speed
+
+//linearisation table
+struct{
+	unsigned char commands[128];	//command for each proportional speed
+	bool ready;										//flag for the table being built
+} typedef LinearTable;
+
+void linear_init();																						//build the default table for every motor type
+void linear_setModel(int type, int deadband, int saturation);	//build a table from a deadband and saturation model
+bool linear_setResponse(LinearTable* table, const int* speeds);	//build a table from a measured speed for every command
+int linear_apply(int type, int velocity);												//map a proportional velocity to a motor command with a type's table
+int linear_applyTable(const LinearTable* table, int velocity);		//map a proportional velocity to a motor command with a table
+
+#endif /* LINEAR_H_ */
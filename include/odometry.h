@@ -0,0 +1,54 @@
+/*
+ * @file odometry.h
+ *
+ * @brief Odometry for a differential drive. A fixed rate task integrates
+ *		  the drive encoder deltas along the heading into a robot pose,
+ *		  using fixed-point math since the Cortex has no FPU. Distances
+ *		  are in drive encoder counts and headings are in degrees,
+ *		  counterclockwise from the heading the robot started at.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ODOMETRY_H_
+#define ODOMETRY_H_
+
+#include <NDAPI.h>
+#include <heading.h>
+#include <trig.h>
+
+#define ODOMETRY_PERIOD 10	//default integration period in milliseconds
+
+//robot pose data structure
+struct{
+	Fixed x;								//distance forward of the start in encoder counts
+	Fixed y;								//distance left of the start in encoder counts
+	Fixed heading;					//heading in degrees, counterclockwise and not wrapped
+	unsigned long stamp;		//time the pose was integrated in milliseconds
+} typedef Pose;
+
+void odometry_init(const Sensor* left, const Sensor* right, const Sensor* gyro, int track);	//set the sensors the pose is integrated from
+void odometry_start(unsigned long period);				//start the odometry task
+void odometry_stop();															//stop the odometry task
+void odometry_step();															//integrate the sensor changes since the last step
+void odometry_setPose(Fixed x, Fixed y, Fixed heading);	//set the current pose
+Pose odometry_getPose();													//retrieve the latest pose
+Fixed odometry_getX();														//retrieve the latest x position
+Fixed odometry_getY();														//retrieve the latest y position
+Fixed odometry_getHeading();											//retrieve the latest heading
+Fixed odometry_getGyroBias();											//retrieve the learned gyro drift per step
+
+#endif /* ODOMETRY_H_ */
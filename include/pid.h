@@ -0,0 +1,108 @@
+/*
+ * @file pid.h
+ *
+ * @brief PID controller data structure and prototypes. The controller
+ *		  runs at a fixed sample period and tracks when the system it is
+ *		  driving has settled so that gains can be tuned from the
+ *		  recorded settle statistics.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PID_H_
+#define PID_H_
+
+#include <API.h>
+#include <fixed.h>
+
+//default controller settings
+#define PID_PERIOD          20		//default sample period in milliseconds
+#define PID_SETTLE_ERROR    10		//default settled error band in sensor units
+#define PID_SETTLE_VELOCITY 5			//default settled velocity band in sensor units per sample
+#define PID_SETTLE_SAMPLES  5			//default number of samples the system must stay settled
+#define PID_TIMEOUT         5000	//default run timeout in milliseconds (0 for no timeout)
+
+//pid controller data structure
+struct{
+	//gains
+	Fixed kP;									//proportional gain
+	Fixed kI;									//integral gain
+	Fixed kD;									//derivative gain
+
+	//limits
+	Fixed integralMax;				//clamp for the magnitude of the integral term
+	Fixed dFilter;						//derivative low pass filter coefficient (0 = no filtering, <1)
+	int outMin;								//minimum controller output
+	int outMax;								//maximum controller output
+	unsigned long period;			//sample period in milliseconds
+
+	//settle detection
+	int settleError;					//error must be within this band to be settled
+	int settleVelocity;				//sensor velocity must be within this band to be settled
+	int settleSamples;				//number of consecutive samples inside both bands
+	unsigned long timeout;		//run is abandoned after this many milliseconds (0 for none)
+
+	//state
+	int target;								//current target value
+	int lastValue;						//sensor value from the previous sample
+	Fixed integral;						//accumulated integral term
+	Fixed derivative;					//filtered derivative term
+	int output;								//last controller output
+	bool first;								//flag for the first sample of a run
+	int direction;						//sign of the error at the start of the run
+	bool settled;							//flag for the run being settled
+	int settledCount;					//consecutive samples inside the settle bands
+
+	//statistics
+	unsigned long samples;		//samples taken in the current run
+	unsigned long settleTime;	//time in milliseconds the last run took to settle
+	int overshoot;						//largest overshoot past the target in the current run
+	unsigned int runs;				//number of runs that have settled
+	unsigned int timeouts;		//number of runs that timed out before settling
+	unsigned long worstTime;	//longest settle time of any run
+	unsigned long totalTime;	//sum of the settle time of every settled run
+} typedef PID;
+
+PID pid_init(Fixed kP, Fixed kI, Fixed kD);																	//initialize the pid controller
+void pid_setLimits(PID* pid, int outMin, int outMax, int integralMax);			//set the output and integral limits
+void pid_setFilter(PID* pid, Fixed dFilter);																//set the derivative filter coefficient
+void pid_setPeriod(PID* pid, unsigned long period);													//set the sample period
+void pid_setSettle(PID* pid, int error, int velocity, int samples);					//set the settle detection thresholds
+void pid_setTimeout(PID* pid, unsigned long timeout);												//set the run timeout
+void pid_setTarget(PID* pid, int target);																		//set the target, starting a new run if it changed
+void pid_moveTarget(PID* pid, int target);																	//move the target without starting a new run
+void pid_reset(PID* pid);																										//restart the current run
+int pid_update(PID* pid, int value);																				//run one sample of the controller
+bool pid_isSettled(PID pid);																								//check if the current run has settled
+bool pid_isTimedOut(PID pid);																								//check if the current run has timed out
+int pid_getTarget(PID pid);																									//retrieve the target of the controller
+int pid_getOutput(PID pid);																									//retrieve the last output of the controller
+unsigned long pid_getPeriod(PID pid);																				//retrieve the sample period
+unsigned long pid_getSettleTime(PID pid);																		//retrieve the settle time of the last run
+unsigned long pid_getAverageSettleTime(PID pid);														//retrieve the average settle time of all runs
+int pid_getOvershoot(PID pid);																							//retrieve the largest overshoot of the current run
+void pid_clearStats(PID* pid);																							//clear the settle statistics
+
+//const pointer accessors, inlined so control loops do not copy the controller
+static inline bool pid_isSettledRef(const PID* pid){return pid->settled;}
+static inline bool pid_isTimedOutRef(const PID* pid){return !pid->settled && pid->timeout > 0 && pid->samples * pid->period >= pid->timeout;}
+static inline int pid_getTargetRef(const PID* pid){return pid->target;}
+static inline int pid_getOutputRef(const PID* pid){return pid->output;}
+static inline unsigned long pid_getPeriodRef(const PID* pid){return pid->period;}
+static inline unsigned long pid_getSettleTimeRef(const PID* pid){return pid->settleTime;}
+static inline int pid_getOvershootRef(const PID* pid){return pid->overshoot;}
+
+#endif /* PID_H_ */
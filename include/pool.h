@@ -0,0 +1,58 @@
+/*
+ * @file pool.h
+ *
+ * @brief Fixed capacity memory pools for the Motor, port and Sensor
+ *		  arrays used by MotorSystem, Sensor and SensorSystem. The pools
+ *		  are sized at compile time for every motor and sensor port on
+ *		  the CORTEX, so they replace heap allocation with a deterministic
+ *		  bump allocation that never fragments and never returns NULL.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef POOL_H_
+#define POOL_H_
+
+#include <NDAPI.h>
+
+//pool capacities
+#define POOL_MOTORS  20	//motors in every motor system, each port can be in two systems
+#define POOL_PORTS   40	//ports used by every sensor, 10 I2C, 8 analog, 12 digital with room for sharing
+#define POOL_SENSORS 30	//sensors in every sensor system
+#define POOL_WEIGHTS 30	//weights of sensors in weighted sensor systems
+#define POOL_TABLES  4	//linearisation tables of calibrated motor systems
+
+//pools
+#define POOL_MOTOR  0	//motor pool
+#define POOL_PORT   1	//sensor port pool
+#define POOL_SENSOR 2	//sensor pool
+#define POOL_WEIGHT 3	//sensor weight pool
+#define POOL_TABLE  4	//linearisation table pool
+#define POOL_COUNT  5	//number of pools
+
+Motor* pool_allocMotors(int* count);		//allocate motors, count is reduced to what fits
+int* pool_allocPorts(int* count);				//allocate sensor ports, count is reduced to what fits
+Sensor* pool_allocSensors(int* count);	//allocate sensors, count is reduced to what fits
+int* pool_allocWeights(int* count);			//allocate sensor weights, count is reduced to what fits
+LinearTable* pool_allocTables(int* count);	//allocate linearisation tables, count is reduced to what fits
+void pool_reset();											//return every allocation to the pools
+int pool_getUsed(int pool);							//retrieve the number of entries allocated from a pool
+int pool_getPeak(int pool);							//retrieve the most entries ever allocated from a pool
+int pool_getCapacity(int pool);					//retrieve the number of entries in a pool
+unsigned int pool_getOverflows();				//retrieve the number of allocations that did not fit
+void pool_report(FILE* stream);					//write the pool usage as a telemetry line
+
+#endif /* POOL_H_ */
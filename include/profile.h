@@ -0,0 +1,67 @@
+/*
+ * @file profile.h
+ *
+ * @brief Motion profile data structure and prototypes. A profile is a
+ *		  table of position and velocity setpoints, one per sample period,
+ *		  that moves a mechanism from a start position to an end position
+ *		  without exceeding a maximum velocity, acceleration and jerk.
+ *		  Profiles are generated once and then stepped through by a
+ *		  controller, so they can be precomputed during initialization.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include <API.h>
+#include <fixed.h>
+#include <trig.h>
+
+#define PROFILE_SAMPLES 200	//maximum number of setpoints in a profile
+
+//motion profile data structure
+struct{
+	//constraints
+	int maxVelocity;									//maximum velocity in units per second
+	int maxAccel;											//maximum acceleration in units per second squared
+	int maxJerk;											//maximum jerk in units per second cubed (0 for trapezoidal)
+	unsigned long period;							//sample period in milliseconds
+	Fixed kV;													//velocity feedforward gain in motor output per unit per second
+
+	//table
+	int start;												//position the profile starts at
+	int end;													//position the profile ends at
+	int length;												//number of setpoints in the table
+	int index;												//current setpoint while following the profile
+	int position[PROFILE_SAMPLES];		//position setpoints relative to the start
+	int velocity[PROFILE_SAMPLES];		//velocity setpoints in units per second
+} typedef Profile;
+
+Profile profile_init(int maxVelocity, int maxAccel, int maxJerk, unsigned long period);	//initialize the profile constraints
+void profile_setFeedforward(Profile* profile, Fixed kV);																//set the velocity feedforward gain
+bool profile_generate(Profile* profile, int start, int end);														//generate the setpoint table
+void profile_restart(Profile* profile);																									//start following the profile from the beginning
+void profile_step(Profile* profile);																										//advance to the next setpoint
+bool profile_isDone(Profile* profile);																									//check if every setpoint has been followed
+int profile_getStart(Profile* profile);																									//retrieve the start position
+int profile_getEnd(Profile* profile);																										//retrieve the end position
+int profile_getLength(Profile* profile);																								//retrieve the number of setpoints
+int profile_getSetpoint(Profile* profile);																							//retrieve the current position setpoint
+int profile_getVelocity(Profile* profile);																							//retrieve the current velocity setpoint
+int profile_getFeedforward(Profile* profile);																						//retrieve the feedforward output for the current setpoint
+
+#endif /* PROFILE_H_ */
@@ -0,0 +1,59 @@
+/*
+ * @file range.h
+ *
+ * @brief Ultrasonic range history. Every reading of an ultrasonic range
+ *		  finder is timestamped and checked against the recent readings.
+ *		  Readings outside the sensor's range, and jumps that are not
+ *		  confirmed by the next reading, are rejected, so callers always
+ *		  get the latest valid range and how old it is.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RANGE_H_
+#define RANGE_H_
+
+#include <API.h>
+
+#define RANGE_MIN     3			//shortest valid range in cm
+#define RANGE_MAX     300		//longest valid range in cm
+#define RANGE_HISTORY 5			//number of valid readings kept
+#define RANGE_JUMP    30		//change in cm from the recent readings treated as an outlier
+#define RANGE_CONFIRM 2			//agreeing outliers in a row accepted as a real change
+#define RANGE_PERIOD  50		//time in ms after which a repeated reading counts as new
+#define RANGE_NEVER   0xFFFFFFFF	//age of a range finder with no valid reading
+
+//ultrasonic range history
+struct{
+	int values[RANGE_HISTORY];		//valid readings in cm
+	int index;										//position of the newest valid reading
+	int size;											//number of valid readings
+	unsigned long stamp;					//time of the newest valid reading in ms
+	int raw;											//last reading, valid or not
+	unsigned long rawStamp;				//time the last reading was taken in ms
+	int pending;									//outlier waiting to be confirmed
+	int pendingCount;							//number of agreeing outliers in a row
+	unsigned int rejected;				//number of rejected readings
+} typedef Range;
+
+void range_reset(int port);											//forget the history of a range finder
+int range_update(int port, int reading);				//check a new reading and retrieve the latest valid range
+int range_getLatest(int port);									//retrieve the latest valid range
+unsigned long range_getAge(int port);						//retrieve the age of the latest valid range
+bool range_isValid(int port);										//check if a range finder has a valid range
+unsigned int range_getRejected(int port);				//retrieve the number of rejected readings
+
+#endif /* RANGE_H_ */
@@ -27,6 +27,7 @@
 #define ROBOT_H_
 
 #include <NDAPI.h>	//NDA API
+#include <line.h>	//line sensor arrays
 
 //robot modes
 #define COMPETITION 0
@@ -47,6 +48,15 @@
 #define LEFT_DRIVE 2
 #define TURN  3
 #define INTAKE 4
+#define MOTOR_TEMP 5
+
+//drive geometry
+#define DRIVE_TRACK 430	//distance between the drive wheels in drive encoder counts
+#define DRIVE_FULL_SPEED 600	//drive encoder counts per second at full command, unloaded
+
+//monitoring
+#define MONITOR_PERIOD 50		//period in ms the drive speed is fed to the thermal model
+#define MONITOR_REPORT 1000	//period in ms of the telemetry report
 
 //lift positions
 #define LIFT_MAX 2950
@@ -56,6 +66,15 @@
 //lift increment
 #define LIFT_INCREMENT 20
 
+//tilt in degrees that is tipping while the lift is above LIFT_SCORE
+#define LIFT_TIP 12
+
+//lift motion profile constraints
+#define LIFT_VELOCITY 3000		//maximum lift velocity in sensor units per second
+#define LIFT_ACCEL    12000		//maximum lift acceleration in sensor units per second squared
+#define LIFT_JERK     120000	//maximum lift jerk in sensor units per second cubed
+#define LIFT_FEEDFORWARD FIXED(0.03)	//lift motor output per sensor unit per second
+
 //intake positions
 #define INTAKE_MAX 3000
 #define INTAKE_MIN 1000
@@ -74,9 +93,10 @@ struct{
 	char auton;					//the selected autonomous for the match
 	LCD lcd;						//the robot's LCD screen
 	int liftPos;				//the robot's current target lift position
-	double liftConst;		//the robot's lift constant for PID, default is 0.7
+	PID liftPID;				//the robot's lift PID controller, default proportional constant is 0.7
+	Profile liftProfile;	//the robot's lift motion profile
 	int intakePos;			//the robot's current intake position
-	double intakeConst;	//the robot's intake constant for PID. default is 0.7
+	PID intakePID;			//the robot's intake PID controller, default proportional constant is 0.7
 
 	//motor systems
 	MotorSystem rightDrive;		//robot's right drive
@@ -90,6 +110,10 @@ struct{
 	Sensor liftSensor;				//robot's lift sensor
 	Sensor turnSensor;				//robot's turn sensor
 	Sensor intakeSensor;			//robot's intake sensor
+	Sensor accelX;						//robot's accelerometer x axis, pointing forward
+	Sensor accelY;						//robot's accelerometer y axis, pointing left
+	Sensor accelZ;						//robot's accelerometer z axis, pointing up
+	LineArray line;						//robot's line sensor array across the front of the drive, built with line_init on robots that have one
 } Robot;
 
 /* Generic robot functions */
@@ -101,8 +125,10 @@ char robot_getAuton();				//retrieve the robot's autonomous for the match
 char robot_getMode();					//retrieve the robto's current mode
 int robot_getLiftPos();				//retrieve the robot's lift position
 int robot_getIntakePos();			//retrieve the robot's intake position
-double robot_getLiftConst();	//get the PID lift constant value
-double robot_getIntakeConst();//get the PID intake constant value
+double robot_getLiftConst();				//get the PID lift constant value
+double robot_getIntakeConst();			//get the PID intake constant value
+Fixed robot_getLiftConstFixed();		//get the fixed-point PID lift constant value
+Fixed robot_getIntakeConstFixed();	//get the fixed-point PID intake constant value
 
 //lcd methods
 void robot_lcdMenu();	//lcd selection menu
@@ -114,17 +140,23 @@ void robot_setDriveSplit(char left, char right);												//set the robot's dr
 void robot_stop();																											//set the velocity of the drive to zero
 void robot_setDriveFor(char velocity, unsigned int time);								//run drive for a certain amount of time at a certain velocity
 void robot_setDriveForSplit(char left, char right, unsigned int time);	//run drive for a certain amount of time independently
+void robot_startOdometry();																							//start tracking the robot's pose
+void robot_startImpact();																								//start detecting collisions and tipping
+void robot_startMonitor();																							//start feeding the thermal model and reporting temperatures and faults
+bool robot_squareUp(char velocity, unsigned long timeout);								//drive onto a line until both sides of the drive are on it
 
 //lift methods
 void robot_liftToPosition(int pos);		//go to the specified position
-void robot_setLiftConst(double val);	//set the PID lift constant value
+void robot_setLiftConst(double val);			//set the PID lift constant value
+void robot_setLiftConstFixed(Fixed val);	//set the fixed-point PID lift constant value
 
 //intake methods
 void robot_intakeIn();								//set the robot's intake to in
 void robot_intakeOut();								//set the robot's intake to out
 void robot_intakeStop();							//stop the robot's intake
 void robot_positionIntake(int pos);		//go to position for claw
-void robot_setIntakeConst(double val);//set the PID intake constant value
+void robot_setIntakeConst(double val);			//set the PID intake constant value
+void robot_setIntakeConstFixed(Fixed val);	//set the fixed-point PID intake constant value
 
 //free memmory
 void robot_free();	//free the data associated with robot
@@ -0,0 +1,62 @@
+/*
+ * @file sampler.h
+ *
+ * @brief Sensor sampler that reads every registered input sensor once per
+ *		  tick into a double-buffered snapshot. Control code reads the
+ *		  snapshot instead of the hardware, so an IME costs one I2C
+ *		  transaction per tick no matter how often it is read, and every
+ *		  read during a tick sees the same value. Sensor filters run here,
+ *		  once per sample at a fixed rate.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SAMPLER_H_
+#define SAMPLER_H_
+
+#include <NDAPI.h>
+#include <velocity.h>
+
+#define SAMPLER_SENSORS    31	//number of sampler slots, one more than the registered sensors
+#define SAMPLER_FIRST      1		//first slot given to a sensor, slot 0 is reserved so a zero-initialised Sensor is never sampled
+#define SAMPLER_PERIOD     10	//default tick in milliseconds
+#define SAMPLER_FILTERS    8		//maximum number of filtered sensors
+#define SAMPLER_VELOCITIES 8		//maximum number of quadrature encoders with a velocity estimate
+
+//sensor snapshot data structure
+struct{
+	int values[SAMPLER_SENSORS];						//sensor values
+	unsigned long stamps[SAMPLER_SENSORS];	//time in microseconds each value was read, 0 if never read
+	unsigned long tick;											//number of the tick the snapshot was taken on
+} typedef Snapshot;
+
+void sampler_start(unsigned long period);						//start the sampler task
+void sampler_stop();																//stop the sampler task
+bool sampler_isRunning();														//check if the sampler task is running
+void sampler_sample();															//read every registered sensor once into the snapshot
+int sampler_register(const Sensor* sensor);					//register a sensor, returning its slot
+void sampler_update(const Sensor* sensor);					//update a registered sensor after it has changed
+void sampler_invalidate(int id);										//discard a sensor value until it is sampled again
+bool sampler_setFilter(int id, const Filter* filter);	//set the filter run on every sample of a sensor
+void sampler_clear();																//remove every registered sensor
+bool sampler_getValue(int id, int* value);					//retrieve a sensor value from the latest snapshot
+bool sampler_getValues(const int* ids, int* values, bool* sampled, int count);	//retrieve several sensor values from the same tick
+unsigned long sampler_getStamp(int id);							//retrieve the time a sensor value was read
+int sampler_getVelocity(int id);										//retrieve the estimated velocity of an encoder
+int sampler_getAcceleration(int id);								//retrieve the estimated acceleration of an encoder
+unsigned long sampler_getReads();										//retrieve the number of hardware reads the sampler has made
+
+#endif /* SAMPLER_H_ */
@@ -0,0 +1,76 @@
+/*
+ * @file thermal.h
+ *
+ * @brief Thermal model of the PTC fuse inside each 393 motor. The
+ *		  current through each motor port is estimated from the commanded
+ *		  velocity and the motor speed, and the PTC temperature is
+ *		  integrated from that current so motor systems can back off
+ *		  before the fuse trips and cuts power for several seconds.
+ *		  Commands, speeds and limits are all in port command units,
+ *		  after linearisation and reversal, as sent to motorSet.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef THERMAL_H_
+#define THERMAL_H_
+
+#include <API.h>
+#include <fixed.h>
+
+//393 motor and PTC constants
+#define THERMAL_STALL_CURRENT 4800	//stall current in mA at the nominal voltage
+#define THERMAL_NOMINAL_VOLT  7200	//battery voltage in mV the stall current is rated at
+#define THERMAL_HOLD_CURRENT  1000	//largest current in mA the PTC can carry without tripping
+#define THERMAL_AMBIENT       25		//ambient temperature in degrees C
+#define THERMAL_TRIP          100		//PTC trip temperature in degrees C
+#define THERMAL_HYSTERESIS    10		//cooling below the trip temperature needed to reset
+#define THERMAL_TAU           174000	//PTC thermal time constant in ms (5 A trips in about 7 s)
+#define THERMAL_SPEED_TAU     100		//motor speed time constant in ms when speed is not measured
+#define THERMAL_MEASURED      100		//age in ms after which a measured speed is no longer used
+#define THERMAL_PERIOD        20		//default integration period in milliseconds
+#define THERMAL_LOAD          FIXED(0.5)	//assumed speed as a fraction of command when not measured
+
+//output limiting
+#define THERMAL_LIMIT         80		//temperature in degrees C output limiting begins
+#define THERMAL_MARGIN        5			//temperature below trip output is limited to the hold current
+
+//motor thermal state
+struct{
+	Fixed rise;									//PTC temperature above ambient in degrees C
+	Fixed speed;								//motor speed in command units
+	volatile int command;				//last command sent to the port
+	volatile int measured;			//last measured speed in command units
+	volatile unsigned long measuredAt;	//time the speed was measured in milliseconds, 0 if never
+	bool tripped;								//flag for the PTC being tripped
+	unsigned int trips;					//number of times the PTC has tripped
+	unsigned long lastUpdate;		//time of the last update in milliseconds
+} typedef Thermal;
+
+void thermal_start(unsigned long period);			//start the thermal task
+void thermal_stop();													//stop the thermal task
+void thermal_step();													//integrate the model of every port up to now
+void thermal_update(int port, int command);		//record the command sent to a port
+void thermal_setSpeed(int port, int speed);		//set the measured motor speed in command units
+int thermal_limit(int port, int command);			//limit a command so the PTC does not trip
+int thermal_getTemperature(int port);					//retrieve the estimated PTC temperature
+int thermal_getCurrent(int port);							//retrieve the estimated motor current
+bool thermal_isTripped(int port);							//check if the PTC is estimated to be tripped
+unsigned int thermal_getTrips(int port);			//retrieve the number of estimated trips
+int thermal_getHottest();											//retrieve the port with the hottest PTC
+void thermal_report(FILE* stream);						//write every port's temperature as a telemetry line
+
+#endif /* THERMAL_H_ */
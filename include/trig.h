@@ -0,0 +1,41 @@
+/*
+ * @file trig.h
+ *
+ * @brief Table driven fixed-point trigonometry. Angles are fixed-point
+ *		  degrees, matching the odometry and heading estimator. Every
+ *		  function is a table lookup with linear interpolation, which
+ *		  keeps the soft-float libm functions off the Cortex. The worst
+ *		  case errors against libm, checked by test/bench_trig.c:
+ *
+ *		  trig_sin, trig_cos	6e-5 (4 LSB)
+ *		  trig_atan2			0.002 degrees
+ *		  trig_sqrt				7e-5 relative above 1, 3 LSB below 1
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRIG_H_
+#define TRIG_H_
+
+#include <API.h>
+#include <fixed.h>
+
+Fixed trig_sin(Fixed angle);					//sine of an angle in degrees
+Fixed trig_cos(Fixed angle);					//cosine of an angle in degrees
+Fixed trig_atan2(Fixed y, Fixed x);		//angle in degrees of a vector from -180 to 180
+Fixed trig_sqrt(Fixed value);					//square root
+
+#endif /* TRIG_H_ */
@@ -0,0 +1,56 @@
+/*
+ * @file velocity.h
+ *
+ * @brief Encoder velocity estimator data structure and prototypes. The
+ *		  estimator keeps a short history of timestamped counts and
+ *		  measures the velocity over a window that adapts to the speed.
+ *		  At high speed the window is a single sample and the velocity is
+ *		  counts per window. At low speed the window grows until enough
+ *		  counts have been seen and is measured between the samples the
+ *		  counts changed on, which approaches the time between counts.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef VELOCITY_H_
+#define VELOCITY_H_
+
+#include <API.h>
+
+#define VELOCITY_HISTORY 16				//number of samples kept
+#define VELOCITY_COUNTS  8				//counts needed before the window stops growing
+#define VELOCITY_WINDOW  200000		//longest window in microseconds, slower motion is zero
+#define VELOCITY_ACCEL   50000		//window the acceleration is measured over in microseconds
+
+//velocity estimator data structure
+struct{
+	int counts[VELOCITY_HISTORY];							//sampled counts, newest at the index
+	unsigned long stamps[VELOCITY_HISTORY];		//time of each sample in microseconds
+	int index;																//position of the newest sample
+	int size;																	//number of samples in the history
+	int velocity;															//velocity in counts per second
+	int acceleration;													//acceleration in counts per second squared
+	int lastVelocity;													//velocity at the start of the acceleration window
+	unsigned long lastStamp;									//time of the start of the acceleration window
+} typedef Velocity;
+
+Velocity velocity_init();																		//initialize an empty estimator
+void velocity_reset(Velocity* target);											//forget every sample
+int velocity_update(Velocity* target, int count, unsigned long stamp);	//add a sample and estimate the velocity
+int velocity_get(Velocity* target);													//retrieve the velocity
+int velocity_getAcceleration(Velocity* target);							//retrieve the acceleration
+
+#endif /* VELOCITY_H_ */
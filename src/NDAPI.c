@@ -1,4 +1,12 @@
 #include <NDAPI.h>
+#include <pool.h>
+#include <sampler.h>
+#include <ime.h>
+#include <driver.h>
+#include <range.h>
+#include <health.h>
+#include <dio.h>
+#include <button.h>
 
 // -------------------------------------- Motor ------------------------------------------------
 
@@ -13,6 +21,7 @@ Motor motor_init(int port, bool isReversed){
 	Motor tmp;									//motor being returned
 	tmp.reversed = isReversed;	//set the reversed flag
 	tmp.port = port;						//set the motor port
+	tmp.type = MOTOR_393;				//linearise as a 393 motor by default
 	motor_stop(&tmp);						//set motor velocity to zero
 
 	return tmp;
@@ -30,12 +39,50 @@ bool motor_reverse(Motor* target){
 }
 
 /*
- * Set the velocity of the motor.
+ * Find the port command that produces a velocity through a
+ * linearisation table.
+ *
+ * @param target The motor being commanded.
+ * @param velocity The velocity of the motor, from -127 to 127.
+ * @param table The table of the motor's system, NULL for the table of the motor's type.
+ * @return The port command, reversed if the motor is reversed.
+ */
+static int motor_command(const Motor* target, int velocity, const LinearTable* table){
+	int command;	//command that produces the velocity
+
+	//system has a calibrated table
+	if(table != NULL && target->type != MOTOR_RAW)
+		command = linear_applyTable(table, velocity);
+	else
+		command = linear_apply(target->type, velocity);
+
+	//reversed
+	if(target->reversed)
+		command = -command;
+
+	return command;
+}
+
+/*
+ * Write a port command to a motor. Every command sent to a motor port
+ * goes through here so the thermal model knows what the port holds.
+ *
+ * @param target The motor being manipulated.
+ * @param command The port command.
+ */
+static void motor_write(const Motor* target, int command){
+	thermal_update(target->port, command);	//update the motor's thermal model
+	motorSet(target->port, command);				//set the command for the motor
+}
+
+/*
+ * Send a velocity to a motor through a linearisation table.
  *
  * @param target The motor being manipulated.
  * @param velocity The desired velocity of the motor.
+ * @param table The table of the motor's system, NULL for the table of the motor's type.
  */
-void motor_setVelocity(Motor* target, int velocity){
+static void motor_send(Motor* target, int velocity, const LinearTable* table){
 
 	//input velocity is over max limit
 	if(velocity > 127)
@@ -46,14 +93,55 @@ void motor_setVelocity(Motor* target, int velocity){
 		velocity = -127;
 
 	target->velocity = velocity;	//assign the velocity for the motor
+	motor_write(target, motor_command(target, velocity, table));
+}
 
-	//reversed
-	if(target->reversed)
-		motorSet(target->port, -target->velocity);	//set the velocity for the motor
+/*
+ * Find the largest velocity, no larger in magnitude than the one
+ * given, whose port command is not cut by the thermal limit. The limit
+ * works on port commands, so the velocity is searched through the
+ * linearisation table rather than scaled.
+ *
+ * @param target The motor being limited.
+ * @param velocity The desired velocity of the motor, from -127 to 127.
+ * @param table The table of the motor's system, NULL for the table of the motor's type.
+ * @return The limited velocity.
+ */
+static int motor_limit(const Motor* target, int velocity, const LinearTable* table){
+	int command = motor_command(target, velocity, table);	//command for the full velocity
 
-	//not reversed
-	else
-		motorSet(target->port, target->velocity);	//set the velocity for the motor
+	//command is inside the limit
+	if(thermal_limit(target->port, command) == command)
+		return velocity;
+
+	int sign = velocity < 0 ? -1 : 1;	//direction of the velocity
+	int low = 0;											//largest magnitude known to pass
+	int high = abs(velocity);					//smallest magnitude known to be cut
+
+	//search for the largest passing magnitude
+	while(high - low > 1){
+		int middle = (low + high) / 2;
+		command = motor_command(target, sign * middle, table);
+
+		if(thermal_limit(target->port, command) == command)
+			low = middle;
+		else
+			high = middle;
+	}
+
+	return sign * low;
+}
+
+/*
+ * Set the velocity of the motor. The velocity is proportional to
+ * motor speed and is mapped through the linearisation table of the
+ * motor's type before it is sent to the port.
+ *
+ * @param target The motor being manipulated.
+ * @param velocity The desired velocity of the motor.
+ */
+void motor_setVelocity(Motor* target, int velocity){
+	motor_send(target, velocity, NULL);
 }
 
 /*
@@ -63,7 +151,7 @@ void motor_setVelocity(Motor* target, int velocity){
  * @return The current velocity of the motor.
  */
 int motor_getVelocity(Motor target){
-	return target.velocity;
+	return motor_getVelocityRef(&target);
 }
 
 /*
@@ -73,7 +161,7 @@ int motor_getVelocity(Motor target){
  * @return The port of the motor.
  */
 int motor_getPort(Motor target){
-	return target.port;
+	return motor_getPortRef(&target);
 }
 
 /*
@@ -83,7 +171,28 @@ int motor_getPort(Motor target){
  * @return The reversed state of the motor.
  */
 bool motor_isReversed(Motor target){
-	return target.reversed;
+	return motor_isReversedRef(&target);
+}
+
+/*
+ * Set the type of the motor. The type selects the table used to
+ * linearise the motor's response, MOTOR_RAW sends velocities unchanged.
+ *
+ * @param target The motor being manipulated.
+ * @param type The type of the motor.
+ */
+void motor_setType(Motor* target, int type){
+	target->type = type;
+}
+
+/*
+ * Get the type of the motor.
+ *
+ * @param target The motor being accessed.
+ * @return The type of the motor.
+ */
+int motor_getType(Motor target){
+	return motor_getTypeRef(&target);
 }
 
 /*
@@ -109,7 +218,49 @@ void motor_setFor(Motor* target, int velocity, unsigned int time){
 }
 
 /*
- * Run motor until a target sensor value has been reached.
+ * Discard the edges a sensor captured before a move, so only edges
+ * captured during the move can stop it.
+ *
+ * @param obs The sensor that stops the move.
+ */
+static void motor_armEdges(const Sensor* obs){
+
+	//digital input, which may be capturing edges
+	if((obs->type == BUMP || obs->type == LIM) && obs->ports != NULL)
+		edge_flushPin(obs->ports[0]);
+}
+
+/*
+ * Check if a move has reached its target sensor value. Sensors with the
+ * EDGES flag also stop on the first captured edge to the target level,
+ * so a switch that is hit and released between reads still stops the
+ * move.
+ *
+ * @param obs The sensor that stops the move.
+ * @param value The latest sensor value.
+ * @param val The target value of the sensor.
+ * @return If the target has been reached.
+ */
+static bool motor_reached(const Sensor* obs, int value, int val){
+
+	Edge edge;	//edge being taken
+
+	//sensor value has been reached
+	if(value == val)
+		return true;
+
+	//an edge reached the value between reads
+	while(sensor_popEdgeRef(obs, &edge))
+		if(edge.level == val)
+			return true;
+
+	return false;
+}
+
+/*
+ * Run motor until a target sensor value has been reached, or until
+ * the sensor fails. A switch with the EDGES flag stops the motor on its
+ * first edge to the target value.
  *
  * @param target The motor being manipulated.
  * @param obs The sensor that stops the motor.
@@ -117,24 +268,46 @@ void motor_setFor(Motor* target, int velocity, unsigned int time){
  * @param val The target value of the sensor.
  */
 void motor_setTill(Motor* target, Sensor* obs, int velocity, int val){
+	motor_armEdges(obs);									//only edges from this move count
 	motor_setVelocity(target, velocity);	//set motor velocity
-	while(sensor_getValue(*obs) != val);	//run motor until sensor value is reached
-	motor_stop(target);										//stop motor
+	health_rearm(obs->id);								//give the sensor a new chance to move
+
+	//run motor until sensor value is reached or the sensor fails
+	for(int value = sensor_getValueRef(obs); !motor_reached(obs, value, val) && health_watch(obs->id, value, velocity); value = sensor_getValueRef(obs));
+
+	motor_stop(target);	//stop motor
 }
 
 /*
  * Run motor until a target sensor value has been reached with PID.
+ * The controller is sampled once every sample period until it
+ * settles or times out, and stops early if the sensor fails.
  *
  * @param target The motor being manipulated.
  * @param obs The sensor that stops the motor.
- * @param k The PID constant.
+ * @param pid The PID controller driving the motor.
  * @param val The target value of the sensor.
  */
-void motor_setTillPID(Motor* target, Sensor* obs, double k, int val){
+void motor_setTillPID(Motor* target, Sensor* obs, PID* pid, int val){
+
+	unsigned long wake = millis();	//time of the last sample
+
+	pid_setTarget(pid, val);			//set the controller target
+	pid_reset(pid);								//start a new run
+	health_rearm(obs->id);				//give the sensor a new chance to move
+
+	//update motor in PID loop until the controller settles
+	while(!pid_isSettledRef(pid) && !pid_isTimedOutRef(pid)){
+		int value = sensor_getValueRef(obs);		//sensor value for this sample
+		int output = pid_update(pid, value);	//controller output for this sample
 
-	//update motor in PID loop until sensor target value is near
-	while(abs(sensor_getValue(*obs)) != val || (val - sensor_getValue(*obs)) * k < 10)
-		motor_setVelocity(target, (val - sensor_getValue(*obs)) * k );
+		//sensor has failed, stop rather than drive blind
+		if(!health_watch(obs->id, value, output))
+			break;
+
+		motor_setVelocity(target, output);
+		taskDelayUntil(&wake, pid_getPeriodRef(pid));
+	}
 
 	motor_stop(target);	//stop motor
 }
@@ -149,37 +322,60 @@ void motor_setTillPID(Motor* target, Sensor* obs, double k, int val){
  *	@return If the motor system contains the motor.
  */
 bool motorSystem_contains(MotorSystem target, Motor m){
+	return motorSystem_containsRef(&target, &m);
+}
+
+/*
+ *	Check to see if the motor system contains the motor without copying
+ *	either of them.
+ *
+ *	@param target The motor system being evaluated.
+ *	@param m The motor being searched for.
+ *	@return If the motor system contains the motor.
+ */
+bool motorSystem_containsRef(const MotorSystem* target, const Motor* m){
 
 	//search for motor
-	for(int i = 0; i < motorSystem_getSize(target); i++)
-		if(target.motors[i].port == m.port)
+	for(int i = 0; i < motorSystem_getSizeRef(target); i++)
+		if(target->motors[i].port == m->port)
 			return true;
 	return false;
 }
 
 /*
- *	Assign motors to the motor system.
+ *	Assign motors to the motor system. If the motor pool can not hold
+ *	every motor the motor system is returned empty, so a mechanism never
+ *	runs with some of its motors missing; check motorSystem_getSize.
  *
  *	@param motors The amount of motors to be added to the motor system.
  *	@param m The motor being assigned to the motor system.
  *	@param ... Motors being assigned to the motor system.
- *	@return The motor system being initialized.
+ *	@return The motor system being initialized, empty if the motor pool ran out.
  */
 MotorSystem motorSystem_init(const int motors, Motor* m, ...){
 
 	va_list param;			//create list of parameters
 	va_start(param, m);	//start list of parameters
 
-	MotorSystem tmp;																												//motor system being returned
-	tmp.size = motors;																											//set the size to zero
-	tmp.motors = (Motor*)malloc(motorSystem_getSize(tmp) * sizeof(Motor));	//allocate memmory for motor system
+	int count = motors;																//number of motors being assigned
+	MotorSystem tmp;																	//motor system being returned
+	tmp.size = 0;																			//set the size to zero
+	tmp.motors = pool_allocMotors(&count);						//allocate memmory for motor system from the motor pool
+	tmp.table = NULL;																	//linearise with each motor's type table
+
+	//motor pool ran out, a motor system missing motors can not be driven
+	if(count < motors){
+		va_end(param);
+		tmp.motors = NULL;
+		return tmp;
+	}
 
 	//assign motors
-	for(int i = 0; i < motorSystem_getSize(tmp); i++){
+	for(int i = 0; i < count; i++){
 
 		//add the new motor
-		if(m->port > 0 && m->port <= 10 && !motorSystem_contains(tmp, *m))
-			tmp.motors[i] = *m;
+		if(m->port > 0 && m->port <= 10 && !motorSystem_containsRef(&tmp, m))
+			tmp.motors[tmp.size++] = *m;
 
 		m = va_arg(param, Motor*);	//get the next parameter
 	}
@@ -190,7 +386,8 @@ MotorSystem motorSystem_init(const int motors, Motor* m, ...){
 }
 
 /*
- *	Set the velocity of the motor system.
+ *	Set the velocity of the motor system. The velocity is limited by
+ *	the hottest motor in the system so that no PTC trips.
  *
  *	@param target The motor system being manipulated.
  *	@param velocity The new velocity for the motor system.
@@ -205,11 +402,15 @@ void motorSystem_setVelocity(MotorSystem* target, int velocity){
 	else if(velocity < -127)
 		velocity = -127;
 
+	//limit the velocity by the motor closest to tripping
+	for(int i = 0; i < target->size; i++)
+		velocity = motor_limit(&target->motors[i], velocity, target->table);
+
 	target->velocity = velocity;	//set the new motor system velocity
 
 	//set the new velocity for the motors
 	for(int i = 0; i < target->size; i++)
-			motor_setVelocity(&target->motors[i], target->velocity);
+		motor_send(&target->motors[i], target->velocity, target->table);
 }
 
 /*
@@ -219,7 +420,7 @@ void motorSystem_setVelocity(MotorSystem* target, int velocity){
  *	@return The velocity of the motor system.
  */
 int motorSystem_getVelocity(MotorSystem target){
-	return target.velocity;
+	return motorSystem_getVelocityRef(&target);
 }
 
 /*
@@ -229,7 +430,7 @@ int motorSystem_getVelocity(MotorSystem target){
  *	@return The size of the motor system.
  */
 int motorSystem_getSize(MotorSystem target){
-	return target.size;
+	return motorSystem_getSizeRef(&target);
 }
 
 /*
@@ -255,7 +456,9 @@ void motorSystem_setFor(MotorSystem* target, int velocity, unsigned int time){
 }
 
 /*
- * Run the motor system until a target sensor value has been reached.
+ * Run the motor system until a target sensor value has been reached,
+ * or until the sensor fails. A switch with the EDGES flag stops the
+ * motor system on its first edge to the target value.
  *
  * @param target The motor system being manipulated.
  * @param obs The sensor that stops the motor system.
@@ -263,35 +466,168 @@ void motorSystem_setFor(MotorSystem* target, int velocity, unsigned int time){
  * @param val The target value of the sensor.
  */
 void motorSystem_setTill(MotorSystem* target, Sensor* obs, int velocity, int val){
+	motor_armEdges(obs);												//only edges from this move count
 	motorSystem_setVelocity(target, velocity);	//set motor system velocity
-	while(sensor_getValue(*obs) != val);				//run motor system until sensor value is reached
-	motorSystem_stop(target);										//stop motor system
+	health_rearm(obs->id);											//give the sensor a new chance to move
+
+	//run motor system until sensor value is reached or the sensor fails
+	for(int value = sensor_getValueRef(obs); !motor_reached(obs, value, val) && health_watch(obs->id, value, velocity); value = sensor_getValueRef(obs));
+
+	motorSystem_stop(target);	//stop motor system
 }
 
 /*
  * Run the motor system until a target sensor value has been reached using PID.
+ * The controller is sampled once every sample period until it settles or
+ * times out, and stops early if the sensor fails.
  *
  * @param target The motor system being manipulated.
  * @param obs The sensor that stops the motor system.
- * @param k The PID constant.
+ * @param pid The PID controller driving the motor system.
  * @param val The target value of the sensor.
  */
-void motorSystem_setTillPID(MotorSystem* target, Sensor* obs, double k, int val){
+void motorSystem_setTillPID(MotorSystem* target, Sensor* obs, PID* pid, int val){
+
+	unsigned long wake = millis();	//time of the last sample
+
+	pid_setTarget(pid, val);			//set the controller target
+	pid_reset(pid);								//start a new run
+	health_rearm(obs->id);				//give the sensor a new chance to move
+
+	//update motor system in PID loop until the controller settles
+	while(!pid_isSettledRef(pid) && !pid_isTimedOutRef(pid)){
+		int value = sensor_getValueRef(obs);		//sensor value for this sample
+		int output = pid_update(pid, value);	//controller output for this sample
+
+		//sensor has failed, stop rather than drive blind
+		if(!health_watch(obs->id, value, output))
+			break;
+
+		motorSystem_setVelocity(target, output);
+		taskDelayUntil(&wake, pid_getPeriodRef(pid));
+	}
+
+	motorSystem_stop(target);	//stop motor system
+}
+
+/*
+ * Run the motor system along a generated motion profile. The PID
+ * controller follows each setpoint with the profile's velocity
+ * feedforward added, then holds the end position until it settles
+ * or times out. The motor system stops early if the sensor fails.
+ *
+ * @param target The motor system being manipulated.
+ * @param obs The sensor the profile is followed with.
+ * @param pid The PID controller driving the motor system.
+ * @param profile The generated motion profile being followed.
+ */
+void motorSystem_followProfile(MotorSystem* target, Sensor* obs, PID* pid, Profile* profile){
 
-	//update motor system in PID loop until sensor target value is near
-	while(abs(sensor_getValue(*obs)) != val || (val - sensor_getValue(*obs)) * k < 10)
-		motorSystem_setVelocity(target, (val - sensor_getValue(*obs)) * k );
+	unsigned long wake = millis();	//time of the last sample
+
+	profile_restart(profile);													//start at the first setpoint
+	pid_setTarget(pid, profile_getSetpoint(profile));	//set the controller target
+	pid_reset(pid);																		//start a new run
+	health_rearm(obs->id);														//give the sensor a new chance to move
+
+	//follow the profile then hold until the controller settles
+	while(!profile_isDone(profile) || (!pid_isSettledRef(pid) && !pid_isTimedOutRef(pid))){
+		int value = sensor_getValueRef(obs);																							//sensor value for this sample
+		pid_moveTarget(pid, profile_getSetpoint(profile));
+		int output = pid_update(pid, value) + profile_getFeedforward(profile);	//controller output for this sample
+
+		//sensor has failed, stop rather than drive blind
+		if(!health_watch(obs->id, value, output))
+			break;
+
+		motorSystem_setVelocity(target, output);
+		profile_step(profile);
+		taskDelayUntil(&wake, pid_getPeriodRef(pid));
+	}
 
 	motorSystem_stop(target);	//stop motor system
 }
 
 /*
- * Free the allocated memmory stored in the motor vector of the motor system.
+ * Measure the response of the motor system and build its own
+ * linearisation table, so other systems with the same motor type are
+ * not affected. The motors are stepped through raw commands from 0 to
+ * 127 and the speed at each step is measured with the sensor, so the
+ * mechanism must be free to move for about five seconds. The size of
+ * each move is measured, so a sensor counting down works too. A
+ * response that never moves or does not rise with the command is
+ * rejected and the system keeps the table it had.
+ *
+ * @param target The motor system being calibrated.
+ * @param obs The sensor measuring the motor system's position.
+ * @return If the table was rebuilt.
+ */
+bool motorSystem_calibrate(MotorSystem* target, Sensor* obs){
+
+	//no motors to calibrate
+	if(motorSystem_getSizeRef(target) == 0)
+		return false;
+
+	int speeds[128];	//measured speed for each command
+	int step = 8;			//commands between measurements
+	int last = 0;			//last command measured
+
+	speeds[0] = 0;	//motors do not move at zero
+
+	//measure the speed at each step
+	for(int i = step; i <= 127 + step - 1; i += step){
+		int command = i > 127 ? 127 : i;	//command being measured
+
+		//send the raw command to every motor
+		for(int j = 0; j < target->size; j++)
+			motor_write(&target->motors[j], target->motors[j].reversed ? -command : command);
+
+		delay(100);																					//let the motors reach speed
+		int start = sensor_getValueRef(obs);									//position at the start of the measurement
+		delay(200);																					//measure for a fixed time
+		speeds[command] = abs(sensor_getValueRef(obs) - start);	//speed at the command
+
+		//fill in the commands between measurements
+		for(int j = last + 1; j < command; j++)
+			speeds[j] = speeds[last] + (speeds[command] - speeds[last]) * (j - last) / (command - last);
+
+		last = command;
+	}
+
+	motorSystem_stop(target);	//stop the motor system
+
+	LinearTable table;	//table built from the measurements
+
+	//response is not usable
+	if(!linear_setResponse(&table, speeds))
+		return false;
+
+	//give the system its own table
+	if(target->table == NULL){
+		int count = 1;	//number of tables wanted
+		LinearTable* allocated = pool_allocTables(&count);
+
+		//table pool is full
+		if(count == 0)
+			return false;
+
+		target->table = allocated;
+	}
+
+	*target->table = table;
+	return true;
+}
+
+/*
+ * Release the motor system. Motor systems are allocated from the motor
+ * pool, which is only returned as a whole by pool_reset, so this just
+ * empties the motor system.
  *
  * @param target The motor system being freed.
  */
 void motorSystem_free(MotorSystem* target){
-	free(target->motors);
+	target->size = 0;
+	target->table = NULL;
 }
 
 // ---------------------------------------- Sensor ---------------------------------------------
@@ -299,85 +635,58 @@ void motorSystem_free(MotorSystem* target){
 /*
  * Set up and initialize the sensor.
  *
- * @param sensorType The type of sensor being initialized.
+ * @param sensorType The type of sensor being initialized, BUMP and LIM may include the EDGES flag
+ *				     and POT, LINE and LIGHT the HIRES flag.
  * @param port The desired port for the motor.
  * @param ... The desired ports for the motor or the multiplier if it is a gyro sensor.
- * @return The sensor being initialized.
+ * @return The sensor being initialized, without ports or a sampler slot if its type has
+ *		   no driver or the port pool ran out.
  */
 Sensor sensor_init(int sensorType, int port, ...){
 
 	va_list param;					//create list of parameters
 	va_start(param, port);	//start list of parameters
 
-	Sensor tmp;							//sensor being returned
-	tmp.type = sensorType;	//set the sensor type
-	tmp.size = 0;						//set the size to zero
-	tmp.opposite = false;		//lower opposite flag
-
-	//sensor uses 2 ports or is a GYRO
-	if(sensor_getType(tmp) == QME || sensor_getType(tmp) == USRF)
-		tmp.size = 2;
-
-	//sensor uses 1 port
-	else
-		tmp.size = 1;
-
-	tmp.ports = (int*)malloc(sizeof(int) * sensor_getSize(tmp));	//allocate memmory for motor system
-
-	//assign ports
-	for(int i = 0; i < sensor_getSize(tmp); i++){
-		tmp.ports[i] = port;				//add the new sensor
-		port = va_arg(param, int);	//get the next parameter
-	}
-
-	//initialize gyro sensor
-	if(sensor_getType(tmp) == GYRO){
-		tmp.sensor = gyroInit(tmp.ports[0], va_arg(param, int));	//set sensor to Gyro with user defined multiplier
-		tmp.analog = true;																				//is an analog sensor
+	Sensor tmp;																	//sensor being returned
+	tmp.type = sensorType & ~SENSOR_FLAGS;			//set the sensor type
+	tmp.size = 0;																//set the size to zero
+	tmp.opposite = false;												//lower opposite flag
+	tmp.sensor = NULL;													//set the sensor to null
+	tmp.analog = false;													//not an analog sensor
+	const SensorDriver* driver = driver_get(tmp.type);	//driver for the sensor type
+
+	//sensor type has no driver
+	if(driver == NULL){
+		va_end(param);
+		tmp.ports = NULL;
+		tmp.id = -1;
+		return tmp;
 	}
 
-	//initialize integrated motor encoder on I2C
-	else if(tmp.type == IME){
-		tmp.sensor = NULL;	//set the sensor to null
-		tmp.analog = false;	//not an analog sensor
-		imeInitializeAll();	//initialize all IME
-	}
+	tmp.size = driver->size;									//number of ports the sensor uses
+	tmp.ports = pool_allocPorts(&tmp.size);	//allocate memmory for the ports from the port pool
 
-	//initialize quadrature motor encoder
-	else if(tmp.type == QME){
-		tmp.sensor = encoderInit(tmp.ports[0], tmp.ports[1], tmp.opposite);	//set sensor to be an encoder
-		tmp.analog = false;																									//not an analog sensor
+	//port pool ran out, a sensor missing ports can not be read
+	if(tmp.size < driver->size){
+		va_end(param);
+		tmp.size = 0;
+		tmp.ports = NULL;
+		tmp.id = -1;
+		return tmp;
 	}
 
-	//initialize ultrasonic range finder
-	else if(tmp.type == USRF){
-		tmp.sensor = ultrasonicInit(tmp.ports[0], tmp.ports[1]);	//set sensor to be an ultrasonic range finder
-		tmp.analog = false;																				//not an analog sensor
-	}
-
-	//intialize standard analog input sensor type
-	else if(tmp.type >= POT && tmp.type <= LIGHT){
-		tmp.sensor = NULL;										//set the sensor to null
-		pinMode(tmp.ports[0], INPUT_ANALOG);	//set up IO port for analog reading
-		tmp.analog = true;										//is an analog sensor
-	}
-
-	//initialize standard digital input sensor type
-	else if(tmp.type >= BUMP && tmp.type <= LIM){
-		tmp.sensor = NULL;							//set the sensor to null
-		pinMode(tmp.ports[0], INPUT);		//set up IO port for digital reading
-		tmp.analog = false;							//not an analog sensor
+	//assign ports
+	for(int i = 0; i < sensor_getSizeRef(&tmp); i++){
+		tmp.ports[i] = port;				//add the new sensor
+		if(i + 1 < driver->size)
+			port = va_arg(param, int);	//get the next port
 	}
 
-	//initialize standard digital input sensor type
-	else if(tmp.type == LED || tmp.type == SOL){
-		tmp.sensor = NULL;							//set the sensor to null
-		pinMode(tmp.ports[0], OUTPUT);	//set up IO port for digital writing
-		tmp.analog = false;							//not an analog sensor
-	}
+	driver->init(&tmp, sensorType & SENSOR_FLAGS, &param);	//set up the sensor
 
-	va_end(param);			//end the list of parameters
-	sensor_reset(&tmp);	//reset the sensor
+	va_end(param);										//end the list of parameters
+	tmp.id = sampler_register(&tmp);	//sample and monitor the sensor every tick
+	sensor_reset(&tmp);								//reset the sensor
 	return tmp;
 }
 
@@ -389,8 +698,8 @@ Sensor sensor_init(int sensorType, int port, ...){
  * @param value The value to which the sensor will be set.
  */
 void sensor_set(Sensor* target, int value){
-	if(!sensor_isAnalog(*target))
-		digitalWrite(target->ports[0], value);
+	if(!sensor_isAnalogRef(target) && target->ports != NULL)
+		dio_write(target->ports[0], value);
 }
 
 /*
@@ -401,21 +710,13 @@ void sensor_set(Sensor* target, int value){
  */
 void sensor_reset(Sensor* target){
 
-	//reset integrated motor encoder
-	if(target->type == IME)
-		imeReset(target->ports[0]);
-
-	//reset 2-wire quadrature motor encoder
-	else if(target->type == QME)
-		encoderReset(target->sensor);
+	const SensorDriver* driver = driver_get(target->type);	//driver for the sensor type
 
-	//reset gyro
-	else if(target->type == GYRO)
-		gyroReset(target->sensor);
+	//reset the sensor (regular analog sensors cannot be reset)
+	if(driver != NULL && driver->reset != NULL)
+		driver->reset(target);
 
-	//reset other sensors (regular analog sensors cannot be reset)
-	else if(!sensor_isAnalog(*target))
-		sensor_set(target, 0);
+	sampler_invalidate(target->id);	//read the hardware until the sampler has the reset value
 }
 
 /*
@@ -427,10 +728,11 @@ void sensor_reset(Sensor* target){
 bool sensor_opposite(Sensor* target){
 	target->opposite = !target->opposite;	//reverse opposite
 
-	//the sensor is a quadrature motor encoder
-	if(target->type == QME)
+	//the sensor is an initialized quadrature motor encoder
+	if(target->type == QME && target->ports != NULL)
 		target->sensor = encoderInit(target->ports[0], target->ports[1], target->opposite);
 
+	sampler_update(target);	//sample the reversed sensor
 	return target->opposite;
 }
 
@@ -441,7 +743,7 @@ bool sensor_opposite(Sensor* target){
  * @return The state of the opposite flag.
  */
 bool sensor_isOpposite(Sensor target){
-	return target.opposite;
+	return sensor_isOppositeRef(&target);
 }
 
 /*
@@ -451,7 +753,7 @@ bool sensor_isOpposite(Sensor target){
  * @return The sensor type.
  */
 int sensor_getType(Sensor target){
-	return target.type;
+	return sensor_getTypeRef(&target);
 }
 
 /*
@@ -461,7 +763,7 @@ int sensor_getType(Sensor target){
  * @return The amount of ports the sensor uses.
  */
 int sensor_getSize(Sensor target){
-	return target.size;
+	return sensor_getSizeRef(&target);
 }
 
 /*
@@ -471,29 +773,235 @@ int sensor_getSize(Sensor target){
  * @return The most current sensor value.
  */
 int sensor_getValue(Sensor target){
+	return sensor_getValueRef(&target);
+}
+
+/*
+ * Retrieve the current value of the sensor without copying it. While
+ * the sampler is running this is the value from the latest snapshot,
+ * otherwise the sensor is read from the hardware.
+ *
+ * @param target The sensor being manipulated.
+ * @return The most current sensor value.
+ */
+int sensor_getValueRef(const Sensor* target){
 
-	//integrated motor encoder
-	if(target.type == IME){
-		int value = 0;										//holds integrated motor encoder value
-		imeGet(target.ports[0], &value);	//retrieve value from integrated motor encoder
+	int value;	//value from the snapshot
+
+	//sensor has been sampled
+	if(sampler_getValue(target->id, &value))
 		return value;
-	}
 
-	//2-wire quadrature motor encoder
-	else if(target.type == QME)
-		return encoderGet(target.sensor);
+	return sensor_readRef(target);
+}
+
+/*
+ * Retrieve the velocity of an encoder.
+ *
+ * @param target The sensor being manipulated.
+ * @return The velocity in counts per second.
+ */
+int sensor_getVelocity(Sensor target){
+	return sensor_getVelocityRef(&target);
+}
+
+/*
+ * Retrieve the velocity of an encoder without copying it. Velocity is
+ * estimated by the sampler for QME and IME sensors, other sensors and
+ * encoders read while the sampler is stopped return zero.
+ *
+ * @param target The sensor being manipulated.
+ * @return The velocity in counts per second.
+ */
+int sensor_getVelocityRef(const Sensor* target){
 
-	//ultrasonic sensor
-	else if(target.type == USRF)
-		return ultrasonicGet(target.sensor);
+	//integrated motor encoder velocity is estimated by the IME sweep
+	if(target->type == IME)
+		return sampler_isRunning() && target->ports != NULL ? ime_getVelocity(target->ports[0]) : 0;
 
-	//analog sensor
-	else if(sensor_isAnalog(target))
-		return analogRead(target.ports[0]);
+	return sampler_isRunning() ? sampler_getVelocity(target->id) : 0;
+}
 
-	//digital sensor
-	else
-		return digitalRead(target.ports[0]);
+/*
+ * Retrieve the acceleration of an encoder.
+ *
+ * @param target The sensor being manipulated.
+ * @return The acceleration in counts per second squared.
+ */
+int sensor_getAcceleration(Sensor target){
+	return sensor_getAccelerationRef(&target);
+}
+
+/*
+ * Retrieve the acceleration of an encoder without copying it.
+ *
+ * @param target The sensor being manipulated.
+ * @return The acceleration in counts per second squared.
+ */
+int sensor_getAccelerationRef(const Sensor* target){
+
+	//integrated motor encoder acceleration is estimated by the IME sweep
+	if(target->type == IME)
+		return sampler_isRunning() && target->ports != NULL ? ime_getAcceleration(target->ports[0]) : 0;
+
+	return sampler_isRunning() ? sampler_getAcceleration(target->id) : 0;
+}
+
+/*
+ * Retrieve the number of edges captured on a digital input.
+ *
+ * @param target The sensor being manipulated.
+ * @return The number of edges.
+ */
+unsigned int sensor_getEdges(Sensor target){
+	return sensor_getEdgesRef(&target);
+}
+
+/*
+ * Retrieve the number of edges captured on a digital input without
+ * copying it. Comparing the count between control loop samples shows a
+ * press even if it was released before the switch was read. Only
+ * sensors initialized with the EDGES flag capture edges.
+ *
+ * @param target The sensor being manipulated.
+ * @return The number of edges.
+ */
+unsigned int sensor_getEdgesRef(const Sensor* target){
+
+	//not a digital input, or never initialized
+	if((target->type != BUMP && target->type != LIM) || target->ports == NULL)
+		return 0;
+
+	return edge_getCount(target->ports[0]);
+}
+
+/*
+ * Take the oldest captured edge of a digital input.
+ *
+ * @param target The sensor being manipulated.
+ * @param edge Where the edge is stored.
+ * @return If there was an edge.
+ */
+bool sensor_popEdge(Sensor target, Edge* edge){
+	return sensor_popEdgeRef(&target, edge);
+}
+
+/*
+ * Take the oldest captured edge of a digital input without copying it.
+ * Each pin has its own buffer, so one task can wait on each switch, but
+ * only one task should take the edges of a switch.
+ *
+ * @param target The sensor being manipulated.
+ * @param edge Where the edge is stored.
+ * @return If there was an edge.
+ */
+bool sensor_popEdgeRef(const Sensor* target, Edge* edge){
+
+	//not a digital input, or never initialized
+	if((target->type != BUMP && target->type != LIM) || target->ports == NULL)
+		return false;
+
+	return edge_popPin(target->ports[0], edge);
+}
+
+/*
+ * Retrieve the age of the sensor value.
+ *
+ * @param target The sensor being manipulated.
+ * @return The age in milliseconds.
+ */
+unsigned long sensor_getAge(Sensor target){
+	return sensor_getAgeRef(&target);
+}
+
+/*
+ * Retrieve the age of the sensor value without copying it. For an
+ * ultrasonic range finder this is the age of the latest valid range,
+ * for other sampled sensors the time since they were sampled. Sensors
+ * read from the hardware are always current.
+ *
+ * @param target The sensor being manipulated.
+ * @return The age in milliseconds, RANGE_NEVER for a range finder without a valid range.
+ */
+unsigned long sensor_getAgeRef(const Sensor* target){
+
+	int value;	//value from the snapshot
+
+	//ultrasonic range finder
+	if(target->type == USRF)
+		return target->ports != NULL ? range_getAge(target->ports[0]) : RANGE_NEVER;
+
+	//sensor has been sampled
+	if(sampler_getValue(target->id, &value))
+		return (micros() - sampler_getStamp(target->id)) / 1000;
+
+	return 0;
+}
+
+/*
+ * Read the value of the sensor from the hardware, bypassing the
+ * sampler snapshot. A failed read returns the last good value the
+ * sampler recorded. Only the sampler records reads in the sensor's
+ * health, so tasks reading the same sensor never write its health.
+ *
+ * @param target The sensor being manipulated.
+ * @return The sensor value.
+ */
+int sensor_readRef(const Sensor* target){
+
+	const SensorDriver* driver = driver_get(target->type);	//driver for the sensor type
+	int value = 0;																					//value read from the hardware
+
+	//sensor type has no driver, or the sensor was never initialized
+	if(driver == NULL || target->ports == NULL)
+		return 0;
+
+	bool good = driver->read(target, &value);	//read the hardware
+
+	return good ? value : health_getValue(target->id, value);
+}
+
+/*
+ * Check if the sensor is healthy.
+ *
+ * @param target The sensor being manipulated.
+ * @return If the sensor is healthy.
+ */
+bool sensor_isHealthy(Sensor target){
+	return sensor_isHealthyRef(&target);
+}
+
+/*
+ * Check if the sensor is healthy without copying it. A sensor is
+ * unhealthy when it has gone without a good read, is stuck at either
+ * end of its range, or did not move while a controller drove it.
+ * Sensors that are not sampled are not monitored.
+ *
+ * @param target The sensor being manipulated.
+ * @return If the sensor is healthy.
+ */
+bool sensor_isHealthyRef(const Sensor* target){
+	return health_isHealthy(target->id);
+}
+
+/*
+ * Retrieve the number of faults of the sensor.
+ *
+ * @param target The sensor being manipulated.
+ * @return The number of failed reads, times stuck and times stalled.
+ */
+unsigned int sensor_getFaults(Sensor target){
+	return sensor_getFaultsRef(&target);
+}
+
+/*
+ * Retrieve the number of faults of the sensor without copying it.
+ *
+ * @param target The sensor being manipulated.
+ * @return The number of failed reads, times stuck and times stalled.
+ */
+unsigned int sensor_getFaultsRef(const Sensor* target){
+	return health_getFaults(target->id);
 }
 
 /*
@@ -503,16 +1011,37 @@ int sensor_getValue(Sensor target){
  * @return The state of the analog flag.
  */
 bool sensor_isAnalog(Sensor target){
-	return target.analog;
+	return sensor_isAnalogRef(&target);
+}
+
+/*
+ * Set the filter run on every sample of the sensor. Filters run in the
+ * sampler, so values read while the sampler is stopped are unfiltered.
+ *
+ * @param target The sensor being manipulated.
+ * @param filter The filter being set, an empty filter removes filtering.
+ * @return If the filter was set.
+ */
+bool sensor_setFilter(Sensor* target, const Filter* filter){
+	return sampler_setFilter(target->id, filter);
 }
 
 /*
- * Free the allocated memmory from the sensor.
+ * Release the sensor. Its driver releases the hardware, but sensor
+ * ports are allocated from the port pool, which is only returned as a
+ * whole by pool_reset, so this just empties the sensor.
  *
  * @param target The sensor whose ports are being freed.
  */
 void sensor_free(Sensor* target){
-	free(target->ports);
+
+	const SensorDriver* driver = driver_get(target->type);	//driver for the sensor type
+
+	//release the hardware
+	if(driver != NULL && driver->shutdown != NULL && target->size > 0)
+		driver->shutdown(target);
+
+	target->size = 0;
 }
 
 // ------------------------------------- Sensor System -----------------------------------------
@@ -525,11 +1054,27 @@ void sensor_free(Sensor* target){
  *	@return If the sensor system contains the sensor.
  */
 bool sensorSystem_contains(SensorSystem target, Sensor sensor){
+	return sensorSystem_containsRef(&target, &sensor);
+}
+
+/*
+ *	Check to see if the sensor system contains the sensor without copying
+ *	either of them.
+ *
+ *	@param target The sensor system being evaluated.
+ *	@param sensor The sensor being searched for.
+ *	@return If the sensor system contains the sensor.
+ */
+bool sensorSystem_containsRef(const SensorSystem* target, const Sensor* sensor){
+
+	//sensor was never initialized, it has no port to match
+	if(sensor->ports == NULL)
+		return false;
 
 	//search for sensor
-	for(int i = 0; i < sensorSystem_getSize(target); i++)
-		if(sensor_getType(target.sensors[i]) == sensor_getType(sensor))
-			if(target.sensors[i].ports[0] == sensor.ports[0])
+	for(int i = 0; i < sensorSystem_getSizeRef(target); i++)
+		if(sensor_getTypeRef(&target->sensors[i]) == sensor_getTypeRef(sensor) && target->sensors[i].ports != NULL)
+			if(target->sensors[i].ports[0] == sensor->ports[0])
 				return true;
 	return false;
 }
@@ -547,22 +1092,19 @@ SensorSystem sensorSystem_init(const int sensors, Sensor* sensor, ...){
 	va_list param;						//create list of parameters
 	va_start(param, sensor);	//start list of parameters
 
-	SensorSystem tmp;																														//sensor system being returned
-	tmp.size = sensors;																													//set the size of sensor system
-	tmp.sensors = (Sensor*)malloc(sensorSystem_getSize(tmp) * sizeof(Sensor));	//allocate memmory for sensor system
-
-	//assign sensor ports
-	for(int i = 0; i < sensorSystem_getSize(tmp); i++){
+	int count = sensors;											//number of sensors being assigned
+	SensorSystem tmp;													//sensor system being returned
+	tmp.size = 0;															//set the size of sensor system
+	tmp.sensors = pool_allocSensors(&count);	//allocate memmory for sensor system from the sensor pool
+	tmp.policy = SYSTEM_MEAN;									//average the sensor values
+	tmp.weights = NULL;												//equal weights
 
-		//port being added is valid
-		if(sensorSystem_contains(tmp, *sensor)){
-			i--;					//decrease iterator
-			tmp.size--;		//decrease number of sensors in sensor system
-		}
+	//assign sensors
+	for(int i = 0; i < count; i++){
 
-		//add the new sensor
-		else
-			tmp.sensors[i] = *sensor;
+		//add the new sensor if it was initialized and is not already in the system
+		if(sensor->ports != NULL && !sensorSystem_containsRef(&tmp, sensor))
+			tmp.sensors[tmp.size++] = *sensor;
 
 		sensor = va_arg(param, Sensor*);	//get the next parameter
 	}
@@ -581,7 +1123,7 @@ SensorSystem sensorSystem_init(const int sensors, Sensor* sensor, ...){
 void sensorSystem_set(SensorSystem* target, int value){
 
 	//set the value of the sensor system
-	for(int i = 0; i < sensorSystem_getSize(*target); i++)
+	for(int i = 0; i < sensorSystem_getSizeRef(target); i++)
 		sensor_set(&target->sensors[i], value);
 }
 
@@ -593,7 +1135,7 @@ void sensorSystem_set(SensorSystem* target, int value){
 void sensorSystem_reset(SensorSystem* target){
 
 	//reset sensor system
-	for(int i = 0; i < sensorSystem_getSize(*target); i++)
+	for(int i = 0; i < sensorSystem_getSizeRef(target); i++)
 		sensor_reset(&target->sensors[i]);
 }
 
@@ -604,41 +1146,289 @@ void sensorSystem_reset(SensorSystem* target){
  * @return The number of sensors in the system.
  */
 int sensorSystem_getSize(SensorSystem target){
-	return target.size;
+	return sensorSystem_getSizeRef(&target);
 }
 
 /*
- * Retrieve the average current sensor value.
+ * Retrieve the combined current sensor value.
  *
  * @param target The sensor system being manipulated.
- * @return The average current sensor value.
+ * @return The combined current sensor value.
  */
 int sensorSystem_getValue(SensorSystem target){
+	return sensorSystem_getValueRef(&target);
+}
+
+/*
+ * Collect the current values of the sensors in the system. Sampled
+ * sensors are all copied out of the same snapshot together, so the
+ * values come from the same tick, and other sensors are read from the
+ * hardware.
+ *
+ * @param target The sensor system being accessed.
+ * @param healthy If unhealthy sensors are left out.
+ * @param values Where the sensor values are stored.
+ * @param weights Where the weight of each value is stored.
+ * @return The number of values collected.
+ */
+static int sensorSystem_collect(const SensorSystem* target, bool healthy, int* values, int* weights){
+
+	const Sensor* sensors[POOL_SENSORS];	//sensors being collected
+	int ids[POOL_SENSORS];								//sampler slot of each sensor
+	bool sampled[POOL_SENSORS];						//flag for each sensor having a sampled value
+	int count = 0;												//number of values collected
+
+	//choose each sensor
+	for(int i = 0; i < sensorSystem_getSizeRef(target); i++){
+		const Sensor* sensor = &target->sensors[i];	//sensor being collected
+
+		//leave out an unhealthy sensor
+		if(healthy && !sensor_isHealthyRef(sensor))
+			continue;
+
+		sensors[count] = sensor;
+		ids[count] = sensor->id;
+		weights[count++] = target->weights != NULL ? target->weights[i] : 1;
+	}
+
+	sampler_getValues(ids, values, sampled, count);	//copy the sampled values out together
+
+	//read the sensors that have not been sampled
+	for(int i = 0; i < count; i++)
+		if(!sampled[i])
+			values[i] = sensor_getValueRef(sensors[i]);
+
+	return count;
+}
+
+/*
+ * Retrieve the combined current sensor value without copying the
+ * sensor system or its sensors. The values are combined by the policy
+ * of the system. If every sensor is left out for being unhealthy, all
+ * of them are combined so the system still has a value.
+ *
+ * @param target The sensor system being manipulated.
+ * @return The combined current sensor value.
+ */
+int sensorSystem_getValueRef(const SensorSystem* target){
+
+	int values[POOL_SENSORS];																									//sensor values being combined
+	int weights[POOL_SENSORS];																								//weight of each value
+	int count = sensorSystem_collect(target, target->policy & SYSTEM_HEALTHY, values, weights);	//number of values
+
+	//every sensor is unhealthy
+	if(count == 0)
+		count = sensorSystem_collect(target, false, values, weights);
 
 	//no sensors to pull values from
-	if(sensorSystem_getSize(target) == 0)
+	if(count == 0)
+		return 0;
+
+	int policy = target->policy & ~SYSTEM_HEALTHY;	//policy without its flags
+
+	//median of the values
+	if(policy == SYSTEM_MEDIAN){
+
+		//insertion sort
+		for(int i = 1; i < count; i++){
+			int value = values[i];	//value being sorted
+			int j = i;
+			for(; j > 0 && values[j - 1] > value; j--)
+				values[j] = values[j - 1];
+			values[j] = value;
+		}
+
+		//even number of values, average the middle two
+		if(count % 2 == 0)
+			return (int)(((int64_t)values[count / 2 - 1] + values[count / 2]) / 2);
+
+		return values[count / 2];
+	}
+
+	int64_t sum = 0;		//sum of the weighted values
+	int64_t total = 0;	//sum of the weights
+
+	//sum the values, weighting them for a weighted policy
+	for(int i = 0; i < count; i++){
+		int weight = policy == SYSTEM_WEIGHTED ? weights[i] : 1;	//weight of the value
+		sum += (int64_t)values[i] * weight;
+		total += weight;
+	}
+
+	//every weight is zero
+	if(total == 0)
 		return 0;
 
-	int value = 0;	//the sum of all the sensor values
+	return (int)(sum / total);	//return the average sensor value
+}
+
+/*
+ * Set how the sensor values in the system are combined.
+ *
+ * @param target The sensor system being manipulated.
+ * @param policy SYSTEM_MEAN, SYSTEM_WEIGHTED or SYSTEM_MEDIAN, optionally with the SYSTEM_HEALTHY flag.
+ */
+void sensorSystem_setPolicy(SensorSystem* target, int policy){
+	target->policy = policy;
+}
+
+/*
+ * Retrieve how the sensor values in the system are combined.
+ *
+ * @param target The sensor system being manipulated.
+ * @return The aggregation policy.
+ */
+int sensorSystem_getPolicy(SensorSystem target){
+	return sensorSystem_getPolicyRef(&target);
+}
+
+/*
+ * Set the weight of a sensor for the SYSTEM_WEIGHTED policy, for
+ * example to trust a higher resolution encoder more. Sensors start
+ * with a weight of one. The weights are allocated from the weight pool
+ * the first time one is set.
+ *
+ * @param target The sensor system being manipulated.
+ * @param index The position of the sensor in the system.
+ * @param weight The weight of the sensor, zero to leave it out.
+ * @return If the weight was set.
+ */
+bool sensorSystem_setWeight(SensorSystem* target, int index, int weight){
+
+	//invalid sensor or weight
+	if(index < 0 || index >= sensorSystem_getSizeRef(target) || weight < 0)
+		return false;
+
+	//allocate equal weights
+	if(target->weights == NULL){
+		int count = sensorSystem_getSizeRef(target);	//number of weights needed
+		int* weights = pool_allocWeights(&count);			//weights from the weight pool
+
+		//weights do not fit
+		if(count < sensorSystem_getSizeRef(target))
+			return false;
+
+		for(int i = 0; i < count; i++)
+			weights[i] = 1;
+		target->weights = weights;
+	}
 
-	//get the sum of the sensor values
-	for(int i = 0; i < sensorSystem_getSize(target); i++)
-		value += sensor_getValue(target.sensors[i]);
+	target->weights[index] = weight;
+	return true;
+}
 
-	return value / sensorSystem_getSize(target);	//return the average sensor value
+/*
+ * Retrieve the number of healthy sensors in the system.
+ *
+ * @param target The sensor system being manipulated.
+ * @return The number of healthy sensors.
+ */
+int sensorSystem_getHealthy(SensorSystem target){
+	return sensorSystem_getHealthyRef(&target);
 }
 
 /*
- * Free the sensors from the sensor system. This will not free the data
- * allocation from the sensors that are apart of the system.
+ * Retrieve the number of healthy sensors in the system without copying
+ * it. Redundant sensors can be checked with this before they are
+ * trusted.
+ *
+ * @param target The sensor system being manipulated.
+ * @return The number of healthy sensors.
+ */
+int sensorSystem_getHealthyRef(const SensorSystem* target){
+
+	int count = 0;	//number of healthy sensors
+
+	//count the healthy sensors
+	for(int i = 0; i < sensorSystem_getSizeRef(target); i++)
+		if(sensor_isHealthyRef(&target->sensors[i]))
+			count++;
+
+	return count;
+}
+
+/*
+ * Release the sensor system. Sensor systems are allocated from the
+ * sensor pool, which is only returned as a whole by pool_reset, so this
+ * just empties the sensor system. This will not free the sensors that
+ * are apart of the system.
  *
  * @param target The sensor sytem whose sensors are being freed.
  */
 void sensorSystem_free(SensorSystem* target){
-	free(target->sensors);
+	target->size = 0;
+	target->weights = NULL;
 }
 // ------------------------------------------ LCD ----------------------------------------------
 
+static LCD* lcdTarget;					//lcd flushed by the lcd task, NULL when stopped
+static TaskHandle lcdTask;				//lcd task, NULL when stopped
+static unsigned long lcdPeriod;		//flush period in milliseconds
+static FILE* lcdHeldPort;					//port of the lcd whose held buttons are tracked for presses
+static unsigned int lcdHeld;			//buttons held at the last press check of that lcd
+
+/*
+ * Lcd task. Flushes the lcd once per period.
+ *
+ * @param ignore Unused task parameter.
+ */
+static void lcd_run(void* ignore){
+
+	unsigned long wake = millis();	//time of the last flush
+
+	//flush forever
+	while(true){
+		lcd_flush(lcdTarget);
+		taskDelayUntil(&wake, lcdPeriod);
+	}
+}
+
+/*
+ * Replace the text in the framebuffer of a line. The line is only
+ * marked dirty if its text changes, and it is sent straight away if
+ * the lcd task is not flushing the lcd.
+ *
+ * @param lcd The lcd being manipulated.
+ * @param line The line being written to.
+ * @param text The LCD_WIDTH characters of the line.
+ */
+static void lcd_write(LCD* lcd, unsigned char line, const char* text){
+
+	//invalid line number
+	if(line != TOP && line != BOTTOM)
+		return;
+
+	char* buffer = lcd->lines[line - 1];	//framebuffer of the line
+
+	//text has changed
+	if(memcmp(buffer, text, LCD_WIDTH) != 0){
+		memcpy(buffer, text, LCD_WIDTH);
+		lcd->dirty[line - 1] = true;	//mark the line once it is written
+	}
+
+	//no task to send the line
+	if(lcdTarget != lcd)
+		lcd_flush(lcd);
+}
+
+/*
+ * Write text into a blank line starting at a position. The text is cut
+ * off at the end of the line.
+ *
+ * @param text The LCD_WIDTH + 1 characters of the line being built.
+ * @param pos The position to start the text.
+ * @param buffer The text being written.
+ */
+static void lcd_compose(char* text, unsigned char pos, const char* buffer){
+
+	memset(text, ' ', LCD_WIDTH);	//start with a blank line
+	text[LCD_WIDTH] = '\0';
+
+	//copy buffer into the line
+	for(int i = pos; i < LCD_WIDTH && buffer && buffer[i-pos]; i++)
+		text[i] = buffer[i-pos];
+}
+
 /*
  * Initialize the lcd.
  *
@@ -649,7 +1439,16 @@ LCD lcd_init(FILE* port){
 	LCD tmp;									//temporary lcd that will be returned;
 	tmp.port = port;					//set lcd port
 	lcdInit(tmp.port);				//initialize the lcd
-	lcd_clear(&tmp);					//clear the lcd
+
+	//nothing has been sent to the lcd
+	for(int i = 0; i < LCD_LINES; i++){
+		memset(tmp.lines[i], ' ', LCD_WIDTH);
+		memset(tmp.shown[i], 0, LCD_WIDTH + 1);
+		tmp.lines[i][LCD_WIDTH] = '\0';
+		tmp.dirty[i] = true;
+	}
+
+	lcd_flush(&tmp);					//clear the lcd
 	lcd_backLight(&tmp, ON);	//turn on the lcd backlight
 
 	return tmp;
@@ -662,7 +1461,7 @@ LCD lcd_init(FILE* port){
  * @return The port that the lcd is using.
  */
 FILE* lcd_getPort(LCD lcd){
-	return lcd.port;
+	return lcd_getPortRef(&lcd);
 }
 
 /*
@@ -675,13 +1474,9 @@ FILE* lcd_getPort(LCD lcd){
  */
 char* lcd_getLine(LCD* lcd, unsigned char line){
 
-	//retrieve first line
-	if(line == TOP)
-		return lcd->line1;
-
-	//retrieve second line
-	else if(line == BOTTOM)
-		return lcd->line2;
+	//retrieve the line
+	if(line == TOP || line == BOTTOM)
+		return lcd->lines[line - 1];
 
 	//invalid line number
 	else
@@ -696,19 +1491,10 @@ char* lcd_getLine(LCD* lcd, unsigned char line){
  */
 void lcd_clearLine(LCD* lcd, unsigned char line){
 
-	//clear first line
-	if(line == TOP){
-		for(int i = 0; i < 16; i++)
-			lcd->line1[i] = ' ';
-		lcdSetText(lcd->port, line, lcd->line1);
-	}
+	char text[LCD_WIDTH + 1];	//blank line
 
-	//clear second line
-	else if(line == BOTTOM){
-		for(int i = 0; i < 16; i++)
-			lcd->line2[i] = ' ';
-		lcdSetText(lcd->port, line, lcd->line2);
-	}
+	lcd_compose(text, 0, NULL);
+	lcd_write(lcd, line, text);
 }
 
 /*
@@ -722,39 +1508,20 @@ void lcd_clear(LCD* lcd){
 }
 
 /*
- * Print to a specified line of the lcd.
+ * Print to a specified line of the lcd. The rest of the
+ * line is blanked.
  *
  * @param lcd The lcd being manipulated.
  * @param line The line being written to.
  * @param buffer The text being written to the designated line.
  */
 void lcd_print(LCD* lcd, unsigned char line, const char* buffer){
-
-	//set text for first line
-	if(line == TOP){
-		lcd_clearLine(lcd, TOP);	//clear first line
-
-		//copy buffer into first line
-		for(int i = 0; i < 16 && buffer; i++)
-			lcd->line1[i] = buffer[i];
-
-		lcdSetText(lcd->port, line, lcd->line1);	//set the text on the lcd
-	}
-
-	//set text for second line
-	else if(line == BOTTOM){
-		lcd_clearLine(lcd, BOTTOM);	//clear second line
-
-		//copy buffer into second line
-		for(int i = 0; i < 16 && buffer; i++)
-			lcd->line2[i] = buffer[i];
-
-		lcdSetText(lcd->port, line, lcd->line2);	//set the text on the lcd
-	}
+	lcd_printAt(lcd, line, 0, buffer);
 }
 
 /*
  * Print a string on the specified line at a specified location of the lcd.
+ * The rest of the line is blanked.
  *
  * @param lcd The lcd being manipulated.
  * @param line The line being written to.
@@ -763,27 +1530,10 @@ void lcd_print(LCD* lcd, unsigned char line, const char* buffer){
  */
 void lcd_printAt(LCD* lcd, unsigned char line, unsigned char pos, const char* buffer){
 
-	//set text for first line
-	if(line == TOP){
-		lcd_clearLine(lcd, TOP);	//clear first line
-
-		//copy buffer into first line
-		for(int i = pos; i < 16 && buffer; i++)
-			lcd->line1[i] = buffer[i-pos];
-
-		lcdSetText(lcd->port, line, lcd->line1);	//set the text on the lcd
-	}
-
-	//set text for second line
-	else if(line == BOTTOM){
-		lcd_clearLine(lcd, BOTTOM);	//clear second line
+	char text[LCD_WIDTH + 1];	//line being printed
 
-		//copy buffer into second line
-		for(int i = pos; i < 16 && buffer; i++)
-			lcd->line2[i] = buffer[i-pos];
-
-		lcdSetText(lcd->port, line, lcd->line2);	//set the text on the lcd
-	}
+	lcd_compose(text, pos, buffer);
+	lcd_write(lcd, line, text);
 }
 
 /*
@@ -795,19 +1545,13 @@ void lcd_printAt(LCD* lcd, unsigned char line, unsigned char pos, const char* bu
  */
 void lcd_centerPrint(LCD* lcd, unsigned char line, const char* buffer){
 
-	int start = (16 - strlen(buffer)) / 2;	//starting position for centering
+	int start = (LCD_WIDTH - (int)strlen(buffer)) / 2;	//starting position for centering
 
 	//too big to center
-	if(start >= 16)
+	if(start < 0)
 		start = 0;
 
-	//set text for first line
-	if(line == TOP)
-		lcd_printAt(lcd, TOP, start, buffer);
-
-	//set text for second line
-	else if(line == BOTTOM)
-		lcd_printAt(lcd, BOTTOM, start, buffer);
+	lcd_printAt(lcd, line, start, buffer);
 }
 
 /*
@@ -818,8 +1562,57 @@ void lcd_centerPrint(LCD* lcd, unsigned char line, const char* buffer){
  * @return The button being pressed.
  */
 int lcd_buttonPressed(LCD lcd){
+	return lcd_buttonPressedRef(&lcd);
+}
+
+/*
+ * Retrieve the button on the lcd that is being
+ * pressed without copying the lcd. While the button
+ * task samples the lcd this is its debounced state
+ * and returns straight away.
+ *
+ * @param lcd The lcd being manipulated.
+ * @return The button being pressed.
+ */
+int lcd_buttonPressedRef(const LCD* lcd){
+
+	//button task is sampling the lcd
+	if(lcd->port != NULL && button_getPort() == lcd->port)
+		return button_getState();
+
 	delay(25);												//delay to allow lcd to read button
-	return lcdReadButtons(lcd.port);
+	return lcdReadButtons(lcd->port);
+}
+
+/*
+ * Take the next press of a button on the lcd. While
+ * the button task samples the lcd this is the next
+ * debounced press from its queue. Otherwise the
+ * buttons are read directly and a button counts as
+ * pressed when it is held now but was not held at
+ * the last check.
+ *
+ * @param lcd The lcd being manipulated.
+ * @return The button pressed, 0 if there was no press.
+ */
+int lcd_getPress(const LCD* lcd){
+
+	//button task is sampling the lcd
+	if(lcd->port != NULL && button_getPort() == lcd->port)
+		return button_getPress();
+
+	unsigned int held = lcdReadButtons(lcd->port);	//buttons held now
+
+	//new lcd, buttons already held are not presses
+	if(lcdHeldPort != lcd->port){
+		lcdHeldPort = lcd->port;
+		lcdHeld = held;
+	}
+
+	unsigned int pressed = held & ~lcdHeld;	//buttons held since the last check
+	lcdHeld = held;
+
+	return pressed & -pressed;	//one button at a time, the leftmost first
 }
 
 /*
@@ -830,7 +1623,19 @@ int lcd_buttonPressed(LCD lcd){
  * @return The state of the button being pressed.
  */
 bool lcd_buttonIsPressed(LCD lcd, int btn){
-	return btn == lcd_buttonPressed(lcd);
+	return lcd_buttonIsPressedRef(&lcd, btn);
+}
+
+/*
+ * See if the target button is being pressed without
+ * copying the lcd.
+ *
+ * @param lcd The lcd being manipulated.
+ * @param btn The target button being observed.
+ * @return The state of the button being pressed.
+ */
+bool lcd_buttonIsPressedRef(const LCD* lcd, int btn){
+	return btn == lcd_buttonPressedRef(lcd);
 }
 
 /*
@@ -840,8 +1645,34 @@ bool lcd_buttonIsPressed(LCD lcd, int btn){
  * @param lcd The lcd being manipulated.
  */
 void lcd_waitForRelease(LCD lcd){
-	while(lcd_buttonPressed(lcd) != 0);
+	lcd_waitForReleaseRef(&lcd);
+}
+
+/*
+ * Pause the program until no lcd buttons are being
+ * pressed without copying the lcd. While the button
+ * task samples the lcd the release is already
+ * debounced, so the queued events of the press are
+ * discarded instead of waiting out the bounce.
+ *
+ * @param lcd The lcd being manipulated.
+ */
+void lcd_waitForReleaseRef(const LCD* lcd){
+
+	//button task is sampling the lcd
+	if(lcd->port != NULL && button_getPort() == lcd->port){
+		while(button_getState() != 0)
+			delay(BUTTON_PERIOD);
+		button_flush();
+		return;
+	}
+
+	while(lcd_buttonPressedRef(lcd) != 0);
 	delay(250);
+
+	//nothing is held for the next press check
+	if(lcdHeldPort == lcd->port)
+		lcdHeld = 0;
 }
 
 /*
@@ -851,7 +1682,7 @@ void lcd_waitForRelease(LCD lcd){
  * @retrun The state of the LCD's backlight.
  */
 bool lcd_backLightIsOn(LCD lcd){
-	return lcd.backLight;
+	return lcd_backLightIsOnRef(&lcd);
 }
 
 /*
@@ -862,5 +1693,78 @@ bool lcd_backLightIsOn(LCD lcd){
  */
 void lcd_backLight(LCD* lcd, bool state){
 	lcd->backLight = state;									//alter lcd state
-	lcdSetBacklight(lcd->port, lcd_backLightIsOn(*lcd));	//update lcd backlight
+	lcdSetBacklight(lcd->port, lcd_backLightIsOnRef(lcd));	//update lcd backlight
+}
+
+/*
+ * Send the lines of the lcd that have changed since they were last
+ * sent. A line marked dirty whose text is back to what is shown is
+ * not sent.
+ *
+ * @param lcd The lcd being manipulated.
+ * @return The number of lines sent.
+ */
+int lcd_flush(LCD* lcd){
+
+	int count = 0;	//number of lines sent
+
+	//invalid lcd
+	if(lcd == NULL)
+		return 0;
+
+	//send each changed line
+	for(int i = 0; i < LCD_LINES; i++){
+
+		//line has not been written to
+		if(!lcd->dirty[i])
+			continue;
+
+		lcd->dirty[i] = false;	//clear the flag before copying so a write during the copy marks it again
+
+		char text[LCD_WIDTH + 1];	//copy of the line being sent
+		memcpy(text, lcd->lines[i], LCD_WIDTH);
+		text[LCD_WIDTH] = '\0';
+
+		//text differs from what is shown
+		if(memcmp(text, lcd->shown[i], LCD_WIDTH + 1) != 0){
+			lcdSetText(lcd->port, i + 1, text);
+			memcpy(lcd->shown[i], text, LCD_WIDTH + 1);
+			count++;
+		}
+	}
+
+	return count;
+}
+
+/*
+ * Flush an lcd in the lcd task, starting the task if it is not running.
+ * Prints then only write the framebuffer, and each line is sent at most
+ * once per period. The lcd must stay in place while it is flushed.
+ *
+ * @param lcd The lcd being flushed.
+ * @param period The flush period in milliseconds.
+ */
+void lcd_start(LCD* lcd, unsigned long period){
+	lcdPeriod = period > 0 ? period : LCD_PERIOD;	//set the period
+	lcdTarget = lcd;															//set the lcd being flushed
+
+	//start the task
+	if(lcdTask == NULL)
+		lcdTask = taskCreate(lcd_run, TASK_DEFAULT_STACK_SIZE, NULL, TASK_PRIORITY_DEFAULT);
+}
+
+/*
+ * Stop the lcd task after sending any lines it has not sent yet. Prints
+ * are sent straight away again.
+ */
+void lcd_stop(){
+
+	//stop the task
+	if(lcdTask != NULL){
+		taskDelete(lcdTask);
+		lcdTask = NULL;
+	}
+
+	lcd_flush(lcdTarget);	//send what the task had not sent
+	lcdTarget = NULL;
 }
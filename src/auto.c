@@ -1,8 +1,10 @@
 #include "main.h"
+#include <odometry.h>
 
 void autonomous() {
 	lcd_centerPrint(&Robot.lcd, TOP, "Autonomous Mode");	//print to lcd
 	lcd_centerPrint(&Robot.lcd, BOTTOM, "ACTIVE");			//print to lcd
+	odometry_setPose(0, 0, 0);													//measure the pose from the starting tile
 
 	//play the autonomous that was selected
 	switch(robot_getAuton()){
@@ -0,0 +1,243 @@
+/*
+ * @file button.c
+ *
+ * @brief Implementation of the debounced lcd buttons. Each button keeps
+ *		  a count of the samples that disagree with its accepted state,
+ *		  and the state only flips once that count reaches
+ *		  BUTTON_DEBOUNCE, so contact bounce and a dropped lcd packet do
+ *		  not show up as extra presses.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <button.h>
+
+static FILE* buttonPort;																//port of the lcd being sampled, NULL when stopped
+static volatile unsigned int buttonState;								//debounced buttons being held
+static unsigned char buttonCounts[BUTTON_COUNT];				//samples each button has disagreed with its state
+static unsigned long buttonStamps[BUTTON_COUNT];				//time each button was pressed in milliseconds
+static unsigned int buttonLong;													//buttons whose long press has been reported
+static ButtonEvent buttonEvents[BUTTON_EVENTS];				//queued events
+static volatile unsigned int buttonHead;								//number of events pushed
+static volatile unsigned int buttonTail;								//number of events popped
+static TaskHandle buttonTask;														//button task, NULL when stopped
+static unsigned long buttonPeriod;											//sample period in milliseconds
+
+/*
+ * Button task. Samples the buttons once per period.
+ *
+ * @param ignore Unused task parameter.
+ */
+static void button_run(void* ignore){
+
+	unsigned long wake = millis();	//time of the last sample
+
+	//sample forever
+	while(true){
+		button_step();
+		taskDelayUntil(&wake, buttonPeriod);
+	}
+}
+
+/*
+ * Push an event into the queue. The event is dropped if the queue is
+ * full, since nobody is reading it.
+ *
+ * @param button The button of the event.
+ * @param type The type of the event.
+ * @param stamp The time of the event in milliseconds.
+ */
+static void button_push(unsigned char button, unsigned char type, unsigned long stamp){
+
+	unsigned int head = buttonHead;	//position being pushed to
+
+	//queue is full
+	if(head - buttonTail >= BUTTON_EVENTS)
+		return;
+
+	ButtonEvent* event = &buttonEvents[head & (BUTTON_EVENTS - 1)];	//event being pushed
+	event->button = button;
+	event->type = type;
+	event->stamp = stamp;
+
+	buttonHead = head + 1;	//publish the event once it is written
+}
+
+/*
+ * Sample the buttons of an lcd in the button task, starting the task if
+ * it is not running. The buttons start released and the queue starts
+ * empty.
+ *
+ * @param port The port of the lcd.
+ * @param period The sample period in milliseconds.
+ */
+void button_start(FILE* port, unsigned long period){
+	buttonPeriod = period > 0 ? period : BUTTON_PERIOD;	//set the period
+
+	//start released
+	for(int i = 0; i < BUTTON_COUNT; i++)
+		buttonCounts[i] = 0;
+	buttonState = 0;
+	buttonLong = 0;
+	button_flush();
+
+	buttonPort = port;	//set the lcd being sampled
+
+	//start the task
+	if(buttonTask == NULL)
+		buttonTask = taskCreate(button_run, TASK_DEFAULT_STACK_SIZE, NULL, TASK_PRIORITY_DEFAULT + 1);
+}
+
+/*
+ * Stop the button task. Buttons are read from the lcd directly again.
+ */
+void button_stop(){
+
+	//stop the task
+	if(buttonTask != NULL){
+		taskDelete(buttonTask);
+		buttonTask = NULL;
+	}
+
+	buttonPort = NULL;
+}
+
+/*
+ * Sample the buttons, accept any change that has held for
+ * BUTTON_DEBOUNCE samples and queue its event. The button task calls
+ * this every period.
+ */
+void button_step(){
+
+	//no lcd to sample
+	if(buttonPort == NULL)
+		return;
+
+	unsigned int raw = lcdReadButtons(buttonPort);	//buttons read from the lcd
+	unsigned int state = buttonState;								//debounced buttons
+	unsigned long now = millis();										//time of the sample
+
+	//debounce each button
+	for(int i = 0; i < BUTTON_COUNT; i++){
+		unsigned int bit = 1u << i;	//bit of the button, matching LCD_BTN_LEFT, LCD_BTN_CENTER and LCD_BTN_RIGHT
+
+		//sample agrees with the state
+		if((raw & bit) == (state & bit)){
+			buttonCounts[i] = 0;
+
+			//button has been held long enough
+			if((state & bit) && !(buttonLong & bit) && now - buttonStamps[i] >= BUTTON_HOLD){
+				buttonLong |= bit;
+				button_push(bit, BUTTON_LONG, now);
+			}
+			continue;
+		}
+
+		//change has not held long enough
+		if(++buttonCounts[i] < BUTTON_DEBOUNCE)
+			continue;
+
+		buttonCounts[i] = 0;
+		state ^= bit;
+
+		//button was pressed
+		if(state & bit){
+			buttonStamps[i] = now;
+			buttonLong &= ~bit;
+			button_push(bit, BUTTON_PRESS, now);
+		}
+
+		//button was released
+		else
+			button_push(bit, BUTTON_RELEASE, now);
+	}
+
+	buttonState = state;
+}
+
+/*
+ * Retrieve the port of the lcd the button task is sampling.
+ *
+ * @return The port, NULL if the task is stopped.
+ */
+FILE* button_getPort(){
+	return buttonPort;
+}
+
+/*
+ * Retrieve the debounced buttons being held.
+ *
+ * @return LCD_BTN_LEFT, LCD_BTN_CENTER and LCD_BTN_RIGHT or-ed together.
+ */
+unsigned int button_getState(){
+	return buttonState;
+}
+
+/*
+ * Check if a button is held, after debouncing.
+ *
+ * @param btn The button being checked.
+ * @return If the button is held.
+ */
+bool button_isPressed(int btn){
+	return btn != 0 && (buttonState & btn) == (unsigned int)btn;
+}
+
+/*
+ * Take the oldest event from the queue.
+ *
+ * @param event Where the event is stored.
+ * @return If there was an event.
+ */
+bool button_pop(ButtonEvent* event){
+
+	unsigned int tail = buttonTail;	//position being popped from
+
+	//queue is empty
+	if(tail == buttonHead)
+		return false;
+
+	*event = buttonEvents[tail & (BUTTON_EVENTS - 1)];
+	buttonTail = tail + 1;	//free the event once it is copied
+
+	return true;
+}
+
+/*
+ * Take the next press from the queue. Releases and long presses in
+ * front of it are discarded, which suits menus that only act on
+ * presses.
+ *
+ * @return The button pressed, 0 if there was no press.
+ */
+int button_getPress(){
+
+	ButtonEvent event;	//event being taken
+
+	//look for a press
+	while(button_pop(&event))
+		if(event.type == BUTTON_PRESS)
+			return event.button;
+
+	return 0;
+}
+
+/*
+ * Discard every event in the queue.
+ */
+void button_flush(){
+	buttonTail = buttonHead;
+}
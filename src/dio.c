@@ -0,0 +1,258 @@
+/*
+ * @file dio.c
+ *
+ * @brief Implementation of the digital I/O words. PROS only reads and
+ *		  writes one pin at a time, so a sample reads each input pin in
+ *		  use and a flush writes each changed output pin, but every other
+ *		  access is a bit operation on the words.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <dio.h>
+
+static volatile unsigned int dioInputPins;		//bits of the pins set up as inputs
+static volatile unsigned int dioOutputPins;		//bits of the pins set up as outputs
+static volatile unsigned int dioInputs;				//levels of the input pins at the last sample
+static volatile unsigned int dioOutputs;			//levels the output pins should have
+static unsigned int dioWritten;								//levels last written to the output pins
+static unsigned long dioReads;								//number of pin reads
+static unsigned long dioWrites;								//number of pin writes
+
+/*
+ * Check if a pin is a digital pin.
+ *
+ * @param pin The pin.
+ * @return If the pin is from one to twelve.
+ */
+static bool dio_isPin(unsigned char pin){
+	return pin >= 1 && pin <= DIO_PINS;
+}
+
+/*
+ * Set up a digital pin and track its direction. An output pin is
+ * written low so the output word matches the hardware.
+ *
+ * @param pin The digital pin.
+ * @param mode INPUT, INPUT_PULLUP, INPUT_PULLDOWN, INPUT_FLOATING, OUTPUT or OUTPUT_OD.
+ */
+void dio_setMode(unsigned char pin, unsigned char mode){
+
+	//invalid pin
+	if(!dio_isPin(pin))
+		return;
+
+	unsigned int bit = DIO_BIT(pin);	//bit of the pin
+
+	pinMode(pin, mode);
+
+	//output pin
+	if(mode == OUTPUT || mode == OUTPUT_OD){
+		dioInputPins &= ~bit;
+		dioOutputPins |= bit;
+		dioOutputs &= ~bit;
+		dioWritten &= ~bit;
+		digitalWrite(pin, false);
+		dioWrites++;
+	}
+
+	//input pin
+	else{
+		dioOutputPins &= ~bit;
+		dioInputPins |= bit;
+	}
+}
+
+/*
+ * Retrieve the pins that are set up as outputs.
+ *
+ * @return The bits of the output pins.
+ */
+unsigned int dio_getOutputPins(){
+	return dioOutputPins;
+}
+
+/*
+ * Retrieve the pins that are set up as inputs.
+ *
+ * @return The bits of the input pins.
+ */
+unsigned int dio_getInputPins(){
+	return dioInputPins;
+}
+
+/*
+ * Read every pin that is not a tracked output into the input word, so
+ * pins set up outside this module are read too. The sampler calls this
+ * once per tick, and anything needing every input at once can call it
+ * directly.
+ *
+ * @return The input word.
+ */
+unsigned int dio_sample(){
+
+	unsigned int pins = DIO_ALL & ~dioOutputPins;	//pins being read
+	unsigned int word = 0;												//levels read
+
+	//read each pin
+	for(unsigned char pin = 1; pins != 0; pin++, pins >>= 1)
+		if(pins & 1){
+			if(digitalRead(pin))
+				word |= DIO_BIT(pin);
+			dioReads++;
+		}
+
+	dioInputs = word;
+	return word;
+}
+
+/*
+ * Retrieve the input word from the last sample.
+ *
+ * @return The input word.
+ */
+unsigned int dio_getInputs(){
+	return dioInputs;
+}
+
+/*
+ * Retrieve the level of a pin from the words. Output pins return the
+ * level they are set to, other pins the level at the last sample.
+ *
+ * @param pin The digital pin.
+ * @return The level of the pin.
+ */
+bool dio_get(unsigned char pin){
+
+	//invalid pin
+	if(!dio_isPin(pin))
+		return false;
+
+	return (dio_getState() & DIO_BIT(pin)) != 0;
+}
+
+/*
+ * Set the level of an output pin without writing it to the hardware.
+ *
+ * @param pin The digital pin.
+ * @param level The level of the pin.
+ */
+void dio_set(unsigned char pin, bool level){
+
+	//invalid pin
+	if(!dio_isPin(pin))
+		return;
+
+	dio_setOutputs(level ? DIO_ALL : 0, DIO_BIT(pin));
+}
+
+/*
+ * Set the levels of several output pins without writing them to the
+ * hardware.
+ *
+ * @param word The levels of the pins.
+ * @param mask The bits of the pins being set.
+ */
+void dio_setOutputs(unsigned int word, unsigned int mask){
+	mask &= DIO_ALL;
+	dioOutputs = (dioOutputs & ~mask) | (word & mask);
+}
+
+/*
+ * Retrieve the output word.
+ *
+ * @return The levels the output pins are set to.
+ */
+unsigned int dio_getOutputs(){
+	return dioOutputs & dioOutputPins;
+}
+
+/*
+ * Write the output pins whose level has changed since they were last
+ * written. Pins that are not set up as outputs are never written.
+ *
+ * @return The number of pins written.
+ */
+int dio_flush(){
+
+	unsigned int outputs = dioOutputs;															//levels being written
+	unsigned int changed = (outputs ^ dioWritten) & dioOutputPins;	//output pins that have changed
+	int count = 0;																									//number of pins written
+
+	//write each changed pin
+	for(unsigned char pin = 1; changed != 0; pin++, changed >>= 1)
+		if(changed & 1){
+			digitalWrite(pin, (outputs & DIO_BIT(pin)) != 0);
+			count++;
+		}
+
+	dioWritten = (dioWritten & ~dioOutputPins) | (outputs & dioOutputPins);
+	dioWrites += count;
+	return count;
+}
+
+/*
+ * Set the level of a pin and write it. Output pins are only written if
+ * their level changes. Other pins are written directly, which sets the
+ * pull of an input.
+ *
+ * @param pin The digital pin.
+ * @param level The level of the pin.
+ */
+void dio_write(unsigned char pin, bool level){
+
+	//invalid pin
+	if(!dio_isPin(pin))
+		return;
+
+	//not an output pin
+	if(!(dioOutputPins & DIO_BIT(pin))){
+		digitalWrite(pin, level);
+		dioWrites++;
+		return;
+	}
+
+	dio_set(pin, level);
+	dio_flush();
+}
+
+/*
+ * Retrieve the level of every pin as one word, the output word for
+ * output pins and the input word for every other pin.
+ *
+ * @return The levels of the pins.
+ */
+unsigned int dio_getState(){
+	return (dioOutputs & dioOutputPins) | (dioInputs & ~dioOutputPins);
+}
+
+/*
+ * Retrieve the number of pins read from the hardware.
+ *
+ * @return The number of pin reads.
+ */
+unsigned long dio_getReads(){
+	return dioReads;
+}
+
+/*
+ * Retrieve the number of pins written to the hardware.
+ *
+ * @return The number of pin writes.
+ */
+unsigned long dio_getWrites(){
+	return dioWrites;
+}
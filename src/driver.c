@@ -0,0 +1,464 @@
+/*
+ * @file driver.c
+ *
+ * @brief Drivers for the built in sensor types and the driver table.
+ *		  Drivers are const so they stay in flash, and the table only
+ *		  holds pointers to them.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <driver.h>
+#include <ime.h>
+#include <range.h>
+#include <dio.h>
+#include <sampler.h>
+
+// -------------------------------- Integrated Motor Encoder -----------------------------------
+
+/*
+ * Initialize an integrated motor encoder once its ports are assigned.
+ *
+ * @param target The sensor being initialized.
+ * @param flags The flags the sensor type was given.
+ * @param param The parameters after the ports.
+ */
+static void driver_imeInit(Sensor* target, int flags, va_list* param){
+	target->sensor = NULL;	//set the sensor to null
+	target->analog = false;	//not an analog sensor
+	ime_init();							//initialize the IME chain once
+}
+
+/*
+ * Read the value of an integrated motor encoder. While the sampler is
+ * running the chain is swept once per tick, so the count from the sweep
+ * is used rather than another I2C read.
+ *
+ * @param target The sensor being read.
+ * @param value Where the sensor value is stored.
+ * @return If the read succeeded.
+ */
+static bool driver_imeRead(const Sensor* target, int* value){
+
+	//count from the sampler's sweep
+	if(sampler_isRunning())
+		return ime_getCount(target->ports[0], value);
+
+	return imeGet(target->ports[0], value);	//retrieve value from integrated motor encoder
+}
+
+/*
+ * Set the value of an integrated motor encoder to zero.
+ *
+ * @param target The sensor being reset.
+ */
+static void driver_imeReset(Sensor* target){
+	ime_reset(target->ports[0]);
+}
+
+static const SensorDriver imeDriver = {1, driver_imeInit, driver_imeRead, driver_imeReset, NULL};
+
+// ------------------------------- Quadrature Motor Encoder ------------------------------------
+
+/*
+ * Initialize a quadrature motor encoder once its ports are assigned.
+ *
+ * @param target The sensor being initialized.
+ * @param flags The flags the sensor type was given.
+ * @param param The parameters after the ports.
+ */
+static void driver_qmeInit(Sensor* target, int flags, va_list* param){
+	target->sensor = encoderInit(target->ports[0], target->ports[1], target->opposite);	//set sensor to be an encoder
+	target->analog = false;																													//not an analog sensor
+}
+
+/*
+ * Read the value of a quadrature motor encoder.
+ *
+ * @param target The sensor being read.
+ * @param value Where the sensor value is stored.
+ * @return If the read succeeded.
+ */
+static bool driver_qmeRead(const Sensor* target, int* value){
+	*value = encoderGet(target->sensor);
+	return true;
+}
+
+/*
+ * Set the value of a quadrature motor encoder to zero.
+ *
+ * @param target The sensor being reset.
+ */
+static void driver_qmeReset(Sensor* target){
+	encoderReset(target->sensor);
+}
+
+/*
+ * Release the hardware used by a quadrature motor encoder.
+ *
+ * @param target The sensor being shut down.
+ */
+static void driver_qmeShutdown(Sensor* target){
+	encoderShutdown(target->sensor);
+}
+
+static const SensorDriver qmeDriver = {2, driver_qmeInit, driver_qmeRead, driver_qmeReset, driver_qmeShutdown};
+
+// ------------------------------------------ Gyro ---------------------------------------------
+
+/*
+ * Initialize a gyro once its ports are assigned.
+ *
+ * @param target The sensor being initialized.
+ * @param flags The flags the sensor type was given.
+ * @param param The parameters after the ports.
+ */
+static void driver_gyroInit(Sensor* target, int flags, va_list* param){
+	target->sensor = gyroInit(target->ports[0], va_arg(*param, int));	//set sensor to Gyro with user defined multiplier
+	target->analog = true;																						//is an analog sensor
+}
+
+/*
+ * Read the value of a gyro.
+ *
+ * @param target The sensor being read.
+ * @param value Where the sensor value is stored.
+ * @return If the read succeeded.
+ */
+static bool driver_gyroRead(const Sensor* target, int* value){
+	*value = gyroGet(target->sensor);
+	return true;
+}
+
+/*
+ * Set the value of a gyro to zero.
+ *
+ * @param target The sensor being reset.
+ */
+static void driver_gyroReset(Sensor* target){
+	gyroReset(target->sensor);
+}
+
+/*
+ * Release the hardware used by a gyro.
+ *
+ * @param target The sensor being shut down.
+ */
+static void driver_gyroShutdown(Sensor* target){
+	gyroShutdown(target->sensor);
+}
+
+static const SensorDriver gyroDriver = {1, driver_gyroInit, driver_gyroRead, driver_gyroReset, driver_gyroShutdown};
+
+// ---------------------------------- Ultrasonic Range Finder ----------------------------------
+
+/*
+ * Initialize an ultrasonic range finder once its ports are assigned.
+ *
+ * @param target The sensor being initialized.
+ * @param flags The flags the sensor type was given.
+ * @param param The parameters after the ports.
+ */
+static void driver_usrfInit(Sensor* target, int flags, va_list* param){
+	target->sensor = ultrasonicInit(target->ports[0], target->ports[1]);	//set sensor to be an ultrasonic range finder
+	target->analog = false;																							//not an analog sensor
+	range_reset(target->ports[0]);																			//no valid range yet
+}
+
+/*
+ * Read the value of an ultrasonic range finder. Invalid readings and
+ * unconfirmed jumps are rejected by the range history.
+ *
+ * @param target The sensor being read.
+ * @param value Where the latest valid range in cm is stored, 0 if there has not been one.
+ * @return If the range finder has had a valid range.
+ */
+static bool driver_usrfRead(const Sensor* target, int* value){
+	*value = range_update(target->ports[0], ultrasonicGet(target->sensor));
+	return range_isValid(target->ports[0]);
+}
+
+/*
+ * Release the hardware used by an ultrasonic range finder.
+ *
+ * @param target The sensor being shut down.
+ */
+static void driver_usrfShutdown(Sensor* target){
+	ultrasonicShutdown(target->sensor);
+}
+
+static const SensorDriver usrfDriver = {2, driver_usrfInit, driver_usrfRead, NULL, driver_usrfShutdown};
+
+// ------------------------------------- Analog Input ------------------------------------------
+
+/*
+ * Initialize an analog input once its ports are assigned.
+ *
+ * @param target The sensor being initialized.
+ * @param flags The flags the sensor type was given.
+ * @param param The parameters after the ports.
+ */
+static void driver_analogInit(Sensor* target, int flags, va_list* param){
+	target->sensor = NULL;										//set the sensor to null
+	pinMode(target->ports[0], INPUT_ANALOG);	//set up IO port for analog reading
+	target->analog = true;										//is an analog sensor
+}
+
+/*
+ * Read the value of an analog input.
+ *
+ * @param target The sensor being read.
+ * @param value Where the sensor value is stored.
+ * @return If the read succeeded.
+ */
+static bool driver_analogRead(const Sensor* target, int* value){
+	*value = analogRead(target->ports[0]);
+	return true;
+}
+
+static const SensorDriver analogDriver = {1, driver_analogInit, driver_analogRead, NULL, NULL};
+
+// ------------------------------------ Position Input -----------------------------------------
+
+static int positionOffset[8];		//calibrated value of each analog port
+static bool positionHires[8];		//flag for each analog port being read at high resolution
+
+/*
+ * Initialize a potentiometer, line or light sensor once its ports are
+ * assigned. With the HIRES flag the sensor is calibrated, which takes
+ * half a second and needs the sensor to be still.
+ *
+ * @param target The sensor being initialized.
+ * @param flags The flags the sensor type was given.
+ * @param param The parameters after the ports.
+ */
+static void driver_positionInit(Sensor* target, int flags, va_list* param){
+
+	int port = target->ports[0];	//analog port
+
+	driver_analogInit(target, flags, param);
+
+	//invalid port
+	if(port < 1 || port > 8)
+		return;
+
+	positionHires[port - 1] = (flags & HIRES) != 0;
+
+	//calibrate for high resolution reads
+	if(positionHires[port - 1])
+		positionOffset[port - 1] = analogCalibrate(port);
+}
+
+/*
+ * Read the value of a potentiometer, line or light sensor. High
+ * resolution reads use the oversampled calibrated value, which is the
+ * difference from the calibrated value times 16, so the calibrated
+ * value is added back to keep the reading absolute.
+ *
+ * @param target The sensor being read.
+ * @param value Where the sensor value from 0 to 4095, or 0 to 65520 at high resolution, is stored.
+ * @return If the read succeeded.
+ */
+static bool driver_positionRead(const Sensor* target, int* value){
+
+	int port = target->ports[0];	//analog port
+
+	//high resolution read
+	if(port >= 1 && port <= 8 && positionHires[port - 1])
+		*value = positionOffset[port - 1] * 16 + analogReadCalibratedHR(port);
+	else
+		*value = analogRead(port);
+
+	return true;
+}
+
+static const SensorDriver positionDriver = {1, driver_positionInit, driver_positionRead, NULL, NULL};
+
+// ------------------------------------- Digital Input -----------------------------------------
+
+/*
+ * Initialize a digital input once its ports are assigned.
+ *
+ * @param target The sensor being initialized.
+ * @param flags The flags the sensor type was given.
+ * @param param The parameters after the ports.
+ */
+static void driver_digitalInit(Sensor* target, int flags, va_list* param){
+	target->sensor = NULL;								//set the sensor to null
+	dio_setMode(target->ports[0], INPUT);	//set up IO port for digital reading
+	target->analog = false;							//not an analog sensor
+
+	//capture every edge so short presses are not missed
+	if(flags & EDGES)
+		edge_enable(target->ports[0], INTERRUPT_EDGE_BOTH);
+}
+
+/*
+ * Read the value of a digital input. While the sampler is running every
+ * input is sampled into the input word once per tick, so the level from
+ * the word is used rather than another pin read.
+ *
+ * @param target The sensor being read.
+ * @param value Where the sensor value is stored.
+ * @return If the read succeeded.
+ */
+static bool driver_digitalRead(const Sensor* target, int* value){
+
+	//level from the sampler's input word
+	if(sampler_isRunning())
+		*value = dio_get(target->ports[0]);
+	else
+		*value = digitalRead(target->ports[0]);
+
+	return true;
+}
+
+/*
+ * Set the value of a digital input to zero.
+ *
+ * @param target The sensor being reset.
+ */
+static void driver_digitalReset(Sensor* target){
+	dio_write(target->ports[0], false);
+}
+
+/*
+ * Release the hardware used by a digital input.
+ *
+ * @param target The sensor being shut down.
+ */
+static void driver_digitalShutdown(Sensor* target){
+	edge_disable(target->ports[0]);
+}
+
+static const SensorDriver digitalDriver = {1, driver_digitalInit, driver_digitalRead, driver_digitalReset, driver_digitalShutdown};
+
+// ------------------------------------- Digital Output ----------------------------------------
+
+/*
+ * Initialize a digital output once its ports are assigned.
+ *
+ * @param target The sensor being initialized.
+ * @param flags The flags the sensor type was given.
+ * @param param The parameters after the ports.
+ */
+static void driver_outputInit(Sensor* target, int flags, va_list* param){
+	target->sensor = NULL;								//set the sensor to null
+	dio_setMode(target->ports[0], OUTPUT);	//set up IO port for digital writing
+	target->analog = false;								//not an analog sensor
+}
+
+/*
+ * Read the value of a digital output, which is the level it was last
+ * set to, so the hardware is not read.
+ *
+ * @param target The sensor being read.
+ * @param value Where the sensor value is stored.
+ * @return If the read succeeded.
+ */
+static bool driver_outputRead(const Sensor* target, int* value){
+	*value = dio_get(target->ports[0]);
+	return true;
+}
+
+static const SensorDriver outputDriver = {1, driver_outputInit, driver_outputRead, driver_digitalReset, NULL};
+
+// ------------------------------------------ Table --------------------------------------------
+
+//driver of each sensor type, NULL for unused types
+static const SensorDriver* drivers[DRIVER_TYPES] = {
+	[IME] = &imeDriver,
+	[QME] = &qmeDriver,
+	[GYRO] = &gyroDriver,
+	[ACCEL] = &analogDriver,
+	[USRF] = &usrfDriver,
+	[POT] = &positionDriver,
+	[LINE] = &positionDriver,
+	[LIGHT] = &positionDriver,
+	[BUMP] = &digitalDriver,
+	[LIM] = &digitalDriver,
+	[LED] = &outputDriver,
+	[SOL] = &outputDriver
+};
+
+/*
+ * Register the driver for a sensor type, replacing any driver the type
+ * already has. The driver must stay in place, so it should be a const
+ * or static variable.
+ *
+ * @param type The sensor type.
+ * @param driver The driver, it must have an init and read function.
+ * @return If the driver was registered.
+ */
+bool driver_register(int type, const SensorDriver* driver){
+
+	//invalid type or driver
+	if(type < 0 || type >= DRIVER_TYPES || driver == NULL || driver->init == NULL || driver->read == NULL)
+		return false;
+
+	drivers[type] = driver;
+	return true;
+}
+
+/*
+ * Retrieve the driver for a sensor type.
+ *
+ * @param type The sensor type.
+ * @return The driver, NULL if the type has none.
+ */
+const SensorDriver* driver_get(int type){
+
+	//invalid type
+	if(type < 0 || type >= DRIVER_TYPES)
+		return NULL;
+
+	return drivers[type];
+}
+
+/*
+ * Check if a sensor type is read from one of the sampler's sweeps, the
+ * IME chain sweep or the digital input word, rather than on its own.
+ *
+ * @param type The sensor type.
+ * @return If the type is read from a sweep.
+ */
+bool driver_isSwept(int type){
+	const SensorDriver* driver = driver_get(type);	//driver for the sensor type
+
+	return driver == &imeDriver || driver == &digitalDriver;
+}
+
+/*
+ * Retrieve the largest value of an analog input that can sit at a rail
+ * when it is disconnected or broken, so its health can be monitored.
+ *
+ * @param target The sensor being accessed.
+ * @return The largest value, 0 for sensors that do not rail.
+ */
+int driver_getFull(const Sensor* target){
+
+	int port = target->ports[0];	//first port of the sensor
+
+	//potentiometer, line and light sensors may be read at high resolution
+	if(target->type == POT || target->type == LINE || target->type == LIGHT)
+		return port >= 1 && port <= 8 && positionHires[port - 1] ? 4095 * 16 : 4095;
+
+	//accelerometer axis
+	else if(target->type == ACCEL)
+		return 4095;
+
+	return 0;
+}
@@ -0,0 +1,225 @@
+/*
+ * @file edge.c
+ *
+ * @brief Implementation of the digital edge capture. Each pin has its
+ *		  own buffer, so a task waiting on one switch can drain it without
+ *		  taking the edges of another. The head of a buffer is only
+ *		  written by the interrupt handler and the tail only by its
+ *		  consumer. When a buffer is full new edges are dropped and
+ *		  counted, but the per pin edge counts still see them.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <edge.h>
+
+static Edge edgeBuffer[EDGE_PINS][EDGE_BUFFER];					//captured edges of each pin
+static volatile unsigned int edgeHead[EDGE_PINS];				//number of edges pushed on each pin, written by the handler
+static volatile unsigned int edgeTail[EDGE_PINS];				//number of edges popped on each pin, written by the consumer
+static volatile unsigned int edgeCount[EDGE_PINS];			//number of edges on each pin
+static volatile unsigned long edgeLast[EDGE_PINS];			//time of the last edge on each pin
+static volatile unsigned int edgeDropped;								//number of edges lost to full buffers
+static unsigned int edgeEnabled;												//pins whose edges are captured, bit 0 is pin 1
+
+/*
+ * Interrupt handler for every enabled pin. Kept short since it runs
+ * with interrupts disabled.
+ *
+ * @param pin The pin the edge happened on.
+ */
+static void edge_handler(unsigned char pin){
+
+	unsigned long now = micros();				//time of the edge
+	unsigned int head = edgeHead[pin - 1];	//position being pushed to
+
+	edgeCount[pin - 1]++;
+	edgeLast[pin - 1] = now;
+
+	//buffer is full
+	if(head - edgeTail[pin - 1] >= EDGE_BUFFER){
+		edgeDropped++;
+		return;
+	}
+
+	Edge* edge = &edgeBuffer[pin - 1][head & (EDGE_BUFFER - 1)];	//edge being pushed
+	edge->pin = pin;
+	edge->level = digitalRead(pin);
+	edge->stamp = now;
+
+	edgeHead[pin - 1] = head + 1;	//publish the edge once it is written
+}
+
+/*
+ * Capture the edges of a digital input pin.
+ *
+ * @param pin The digital pin.
+ * @param edges INTERRUPT_EDGE_RISING, INTERRUPT_EDGE_FALLING or INTERRUPT_EDGE_BOTH.
+ */
+void edge_enable(unsigned char pin, unsigned char edges){
+
+	//invalid pin, pin 10 can not be used for interrupts
+	if(pin < 1 || pin > EDGE_PINS || pin == 10)
+		return;
+
+	ioSetInterrupt(pin, edges, edge_handler);
+	edgeEnabled |= 1u << (pin - 1);
+}
+
+/*
+ * Stop capturing the edges of a digital input pin. Edges already in
+ * the buffer are kept.
+ *
+ * @param pin The digital pin.
+ */
+void edge_disable(unsigned char pin){
+
+	//invalid pin
+	if(pin < 1 || pin > EDGE_PINS || pin == 10)
+		return;
+
+	ioClearInterrupt(pin);
+	edgeEnabled &= ~(1u << (pin - 1));
+}
+
+/*
+ * Check if the edges of a digital input pin are being captured.
+ *
+ * @param pin The digital pin.
+ * @return If the pin has edge capture enabled.
+ */
+bool edge_isEnabled(unsigned char pin){
+	return pin >= 1 && pin <= EDGE_PINS && (edgeEnabled & (1u << (pin - 1)));
+}
+
+/*
+ * Take the oldest edge of any pin. This drains every pin, so it should
+ * only be used when one task consumes all of the edges.
+ *
+ * @param edge Where the edge is stored.
+ * @return If there was an edge in any buffer.
+ */
+bool edge_pop(Edge* edge){
+
+	int oldest = -1;							//pin with the oldest edge
+	unsigned long now = micros();	//ages are measured from now so the stamps can wrap
+
+	//find the oldest edge at the front of a buffer
+	for(int i = 0; i < EDGE_PINS; i++){
+		unsigned int tail = edgeTail[i];	//front of the pin's buffer
+
+		//buffer is empty
+		if(tail == edgeHead[i])
+			continue;
+
+		//edge is older than the oldest so far
+		if(oldest < 0 || now - edgeBuffer[i][tail & (EDGE_BUFFER - 1)].stamp > now - edgeBuffer[oldest][edgeTail[oldest] & (EDGE_BUFFER - 1)].stamp)
+			oldest = i;
+	}
+
+	return oldest >= 0 && edge_popPin(oldest + 1, edge);
+}
+
+/*
+ * Take the oldest edge of one pin. Only one task should drain each pin.
+ *
+ * @param pin The digital pin.
+ * @param edge Where the edge is stored.
+ * @return If there was an edge in the pin's buffer.
+ */
+bool edge_popPin(unsigned char pin, Edge* edge){
+
+	//invalid pin
+	if(pin < 1 || pin > EDGE_PINS)
+		return false;
+
+	unsigned int tail = edgeTail[pin - 1];	//position being popped from
+
+	//buffer is empty
+	if(tail == edgeHead[pin - 1])
+		return false;
+
+	*edge = edgeBuffer[pin - 1][tail & (EDGE_BUFFER - 1)];
+	edgeTail[pin - 1] = tail + 1;	//free the slot once it is read
+
+	return true;
+}
+
+/*
+ * Check if any pin has edges in its buffer.
+ *
+ * @return If there are edges to pop.
+ */
+bool edge_pending(){
+
+	//look for a buffer with edges
+	for(int i = 0; i < EDGE_PINS; i++)
+		if(edgeTail[i] != edgeHead[i])
+			return true;
+
+	return false;
+}
+
+/*
+ * Discard the edges of every pin.
+ */
+void edge_flush(){
+
+	//discard each pin
+	for(int i = 1; i <= EDGE_PINS; i++)
+		edge_flushPin(i);
+}
+
+/*
+ * Discard the edges of one pin.
+ *
+ * @param pin The digital pin.
+ */
+void edge_flushPin(unsigned char pin){
+
+	//valid pin
+	if(pin >= 1 && pin <= EDGE_PINS)
+		edgeTail[pin - 1] = edgeHead[pin - 1];
+}
+
+/*
+ * Retrieve the number of edges captured on a pin, including edges
+ * dropped from a full buffer.
+ *
+ * @param pin The digital pin.
+ * @return The number of edges.
+ */
+unsigned int edge_getCount(unsigned char pin){
+	return pin >= 1 && pin <= EDGE_PINS ? edgeCount[pin - 1] : 0;
+}
+
+/*
+ * Retrieve the time of the last edge captured on a pin.
+ *
+ * @param pin The digital pin.
+ * @return The time in microseconds, 0 if there has been no edge.
+ */
+unsigned long edge_getLast(unsigned char pin){
+	return pin >= 1 && pin <= EDGE_PINS ? edgeLast[pin - 1] : 0;
+}
+
+/*
+ * Retrieve the number of edges lost because a buffer was full.
+ *
+ * @return The number of dropped edges.
+ */
+unsigned int edge_getDropped(){
+	return edgeDropped;
+}
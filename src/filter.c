@@ -0,0 +1,294 @@
+/*
+ * @file filter.c
+ *
+ * @brief Implementation of the sensor filter stages. Every stage passes
+ *		  its first sample straight through and then builds up its state
+ *		  from there, so a filter starts from the current reading rather
+ *		  than from zero.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <filter.h>
+
+/*
+ * Add a stage to the end of the filter.
+ *
+ * @param filter The filter being manipulated.
+ * @param type The type of stage.
+ * @param param The window, width or change per sample of the stage.
+ * @param alpha The smoothing factor of the stage.
+ * @return If the filter had room for the stage.
+ */
+static bool filter_add(Filter* filter, int type, int param, Fixed alpha){
+
+	//filter is full
+	if(filter->size >= FILTER_STAGES)
+		return false;
+
+	FilterStage* stage = &filter->stages[filter->size];	//stage being added
+	stage->type = type;
+	stage->param = param;
+	stage->alpha = alpha;
+	stage->count = 0;
+	stage->index = 0;
+	stage->sum = 0;
+	stage->output = 0;
+	stage->fraction = 0;
+	stage->primed = false;
+
+	filter->size++;
+	return true;
+}
+
+/*
+ * Record a sample in the history of a stage.
+ *
+ * @param stage The stage being manipulated.
+ * @param value The sample.
+ */
+static void filter_record(FilterStage* stage, int value){
+
+	//history is full, forget the oldest sample
+	if(stage->count == stage->param)
+		stage->sum -= stage->history[stage->index];
+	else
+		stage->count++;
+
+	stage->history[stage->index] = value;
+	stage->sum += value;
+	stage->index = (stage->index + 1) % stage->param;
+}
+
+/*
+ * Find the median of the history of a stage.
+ *
+ * @param stage The stage being accessed.
+ * @return The median sample.
+ */
+static int filter_median(FilterStage* stage){
+
+	int sorted[FILTER_WINDOW];	//history in ascending order
+
+	//insertion sort, the history is too short for anything else to pay off
+	for(int i = 0; i < stage->count; i++){
+		int j = i;
+		for(; j > 0 && sorted[j - 1] > stage->history[i]; j--)
+			sorted[j] = sorted[j - 1];
+		sorted[j] = stage->history[i];
+	}
+
+	return sorted[stage->count / 2];
+}
+
+/*
+ * Run a sample through a single stage.
+ *
+ * @param stage The stage being manipulated.
+ * @param value The sample.
+ * @return The output of the stage.
+ */
+static int filter_stage(FilterStage* stage, int value){
+
+	//first sample passes through
+	if(!stage->primed){
+		stage->primed = true;
+		stage->output = value;
+		stage->fraction = 0;
+		if(stage->type == FILTER_AVERAGE || stage->type == FILTER_MEDIAN)
+			filter_record(stage, value);
+		return value;
+	}
+
+	int last = stage->output;	//last output of the stage
+
+	switch(stage->type){
+
+		//moving average
+		case FILTER_AVERAGE:
+			filter_record(stage, value);
+			last = stage->sum / stage->count;
+			break;
+
+		//median
+		case FILTER_MEDIAN:
+			filter_record(stage, value);
+			last = filter_median(stage);
+			break;
+
+		//exponential moving average, carrying the fraction so small steps are not lost
+		case FILTER_EMA:{
+			int64_t step = (int64_t)stage->alpha * (value - last) + stage->fraction;	//change in fixed point
+			last += (int)(step >> FIXED_SHIFT);
+			stage->fraction = step & (FIXED_ONE - 1);
+			break;
+		}
+
+		//deadband
+		case FILTER_DEADBAND:
+			if(abs(value - last) > stage->param)
+				last = value;
+			break;
+
+		//rate limit
+		case FILTER_RATE:
+			if(value > last + stage->param)
+				last += stage->param;
+			else if(value < last - stage->param)
+				last -= stage->param;
+			else
+				last = value;
+			break;
+	}
+
+	stage->output = last;
+	return last;
+}
+
+/*
+ * Initialize an empty filter. An empty filter passes samples through
+ * unchanged.
+ *
+ * @return The filter being initialized.
+ */
+Filter filter_init(){
+	Filter tmp;		//filter being returned
+	tmp.size = 0;	//no stages
+
+	return tmp;
+}
+
+/*
+ * Add a moving average stage to the end of the filter.
+ *
+ * @param filter The filter being manipulated.
+ * @param window The number of samples averaged, up to FILTER_WINDOW.
+ * @return If the stage was added.
+ */
+bool filter_addAverage(Filter* filter, int window){
+
+	//invalid window
+	if(window < 1 || window > FILTER_WINDOW)
+		return false;
+
+	return filter_add(filter, FILTER_AVERAGE, window, 0);
+}
+
+/*
+ * Add a median stage to the end of the filter. A median of three or
+ * five removes single sample spikes without delaying steps as much as
+ * an average.
+ *
+ * @param filter The filter being manipulated.
+ * @param window The number of samples searched, up to FILTER_WINDOW.
+ * @return If the stage was added.
+ */
+bool filter_addMedian(Filter* filter, int window){
+
+	//invalid window
+	if(window < 1 || window > FILTER_WINDOW)
+		return false;
+
+	return filter_add(filter, FILTER_MEDIAN, window, 0);
+}
+
+/*
+ * Add an exponential moving average stage to the end of the filter.
+ *
+ * @param filter The filter being manipulated.
+ * @param alpha The fixed-point weight of each new sample, above 0 and up to 1.
+ * @return If the stage was added.
+ */
+bool filter_addEMA(Filter* filter, Fixed alpha){
+
+	//invalid weight
+	if(alpha <= 0 || alpha > FIXED_ONE)
+		return false;
+
+	return filter_add(filter, FILTER_EMA, 0, alpha);
+}
+
+/*
+ * Add a deadband stage to the end of the filter. The output only
+ * follows the input once it has moved more than the width away.
+ *
+ * @param filter The filter being manipulated.
+ * @param width The largest change that is ignored.
+ * @return If the stage was added.
+ */
+bool filter_addDeadband(Filter* filter, int width){
+	return filter_add(filter, FILTER_DEADBAND, abs(width), 0);
+}
+
+/*
+ * Add a rate limit stage to the end of the filter.
+ *
+ * @param filter The filter being manipulated.
+ * @param rate The largest change per sample.
+ * @return If the stage was added.
+ */
+bool filter_addRate(Filter* filter, int rate){
+
+	//invalid rate
+	if(rate == 0)
+		return false;
+
+	return filter_add(filter, FILTER_RATE, abs(rate), 0);
+}
+
+/*
+ * Forget every sample, so the next sample passes through. This should
+ * be done when the sensor is reset.
+ *
+ * @param filter The filter being manipulated.
+ */
+void filter_reset(Filter* filter){
+
+	//reset each stage
+	for(int i = 0; i < filter->size; i++){
+		filter->stages[i].count = 0;
+		filter->stages[i].index = 0;
+		filter->stages[i].sum = 0;
+		filter->stages[i].fraction = 0;
+		filter->stages[i].primed = false;
+	}
+}
+
+/*
+ * Run a sample through every stage of the filter in order.
+ *
+ * @param filter The filter being manipulated.
+ * @param value The sample.
+ * @return The filtered sample.
+ */
+int filter_apply(Filter* filter, int value){
+
+	//run each stage
+	for(int i = 0; i < filter->size; i++)
+		value = filter_stage(&filter->stages[i], value);
+
+	return value;
+}
+
+/*
+ * Retrieve the number of stages in the filter.
+ *
+ * @param filter The filter being accessed.
+ * @return The number of stages.
+ */
+int filter_getSize(Filter* filter){
+	return filter->size;
+}
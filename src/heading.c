@@ -0,0 +1,141 @@
+/*
+ * @file heading.c
+ *
+ * @brief Implementation of the complementary heading estimator. The
+ *		  estimator only adds and multiplies in fixed point, so a step
+ *		  costs well under a microsecond.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <heading.h>
+
+/*
+ * Initialize the estimator at a heading with no gyro bias.
+ *
+ * @param heading The fixed-point heading in degrees.
+ * @return The estimator being initialized.
+ */
+Heading heading_init(Fixed heading){
+	Heading tmp;							//estimator being returned
+	heading_set(&tmp, heading);	//set the heading
+	tmp.bias = 0;							//no bias learned
+	tmp.slips = 0;						//no slip
+
+	return tmp;
+}
+
+/*
+ * Fuse one step of gyro and encoder turn into the heading. This should
+ * be called at a steady rate, since the bias is learned per step.
+ *
+ * @param target The estimator being manipulated.
+ * @param gyroTurn The fixed-point change in gyro heading over the step.
+ * @param encoderTurn The fixed-point change in encoder heading over the step.
+ * @param moving If either drive encoder moved during the step.
+ * @return The fused heading.
+ */
+Fixed heading_update(Heading* target, Fixed gyroTurn, Fixed encoderTurn, bool moving){
+
+	//robot is still, so any gyro change is drift
+	if(!moving){
+		target->still++;
+
+		//average the drift once the robot has settled, the gyro only reports whole degrees
+		if(target->still > HEADING_STILL){
+			target->drift += gyroTurn;
+			if(target->still - HEADING_STILL >= HEADING_BIAS)
+				target->bias = target->drift / (target->still - HEADING_STILL);
+		}
+
+		return target->heading;
+	}
+
+	target->still = 0;
+	target->drift = 0;
+
+	Fixed turn = gyroTurn - target->bias;	//gyro turn without drift
+
+	target->heading += turn;					//follow the gyro
+	target->encoder += encoderTurn;		//follow the encoders
+
+	Fixed error = target->encoder - target->heading;	//disagreement between the encoders and the fused heading
+
+	//wheels have slipped, move the encoder heading back onto the fused heading
+	if(fixed_abs(error) > HEADING_SLIP){
+		target->encoder = target->heading;
+		target->slips++;
+	}
+
+	//pull towards the encoders
+	else
+		target->heading += fixed_mul(HEADING_GAIN, error);
+
+	return target->heading;
+}
+
+/*
+ * Set the heading, keeping the learned bias.
+ *
+ * @param target The estimator being manipulated.
+ * @param heading The fixed-point heading in degrees.
+ */
+void heading_set(Heading* target, Fixed heading){
+	target->heading = heading;
+	target->encoder = heading;
+	target->still = 0;
+	target->drift = 0;
+}
+
+/*
+ * Retrieve the fused heading.
+ *
+ * @param target The estimator being accessed.
+ * @return The fixed-point heading in degrees.
+ */
+Fixed heading_get(Heading* target){
+	return target->heading;
+}
+
+/*
+ * Retrieve the learned gyro drift.
+ *
+ * @param target The estimator being accessed.
+ * @return The fixed-point drift in degrees per step.
+ */
+Fixed heading_getBias(Heading* target){
+	return target->bias;
+}
+
+/*
+ * Check if the robot has been still long enough to learn the bias.
+ *
+ * @param target The estimator being accessed.
+ * @return If the robot is still.
+ */
+bool heading_isStill(Heading* target){
+	return target->still >= HEADING_STILL;
+}
+
+/*
+ * Retrieve the number of times the wheels have slipped.
+ *
+ * @param target The estimator being accessed.
+ * @return The number of slips.
+ */
+unsigned int heading_getSlips(Heading* target){
+	return target->slips;
+}
@@ -0,0 +1,323 @@
+/*
+ * @file health.c
+ *
+ * @brief Implementation of sensor health monitoring. A failed read
+ *		  keeps the last good value so a dropped encoder read does not
+ *		  look like a jump to zero. Analog inputs are stuck when they sit
+ *		  exactly at a rail, where a connected sensor always shows some
+ *		  noise, and encoders are stalled when a controller drives them
+ *		  hard without them moving.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <health.h>
+
+static Health health[SAMPLER_SENSORS];	//health of each sampler slot
+static int healthCount;									//slot after the last slot that has been reset
+
+/*
+ * Retrieve the health of a sampler slot.
+ *
+ * @param id The slot of the sensor.
+ * @return The health, or NULL if the sensor is not sampled.
+ */
+static Health* health_get(int id){
+
+	//sensor is not sampled
+	if(id < SAMPLER_FIRST || id >= SAMPLER_SENSORS)
+		return NULL;
+
+	return &health[id];
+}
+
+/*
+ * Forget the health of a sensor, for example when its slot is given to
+ * a new sensor.
+ *
+ * @param id The slot of the sensor.
+ */
+void health_reset(int id){
+
+	Health* state = health_get(id);	//health of the sensor
+
+	//sensor is not sampled
+	if(state == NULL)
+		return;
+
+	memset(state, 0, sizeof(Health));
+	state->moved = millis();
+
+	//count the slot for reports
+	if(id >= healthCount)
+		healthCount = id + 1;
+}
+
+/*
+ * Record a read of a sensor. A failed read is counted and the last
+ * good value is used in its place. A good read at a rail that has not
+ * changed for HEALTH_STUCK ms marks the sensor as stuck.
+ *
+ * @param id The slot of the sensor.
+ * @param good If the read succeeded.
+ * @param value The value that was read.
+ * @param full The largest value of an analog input, 0 for sensors that do not rail.
+ * @return The value to use for the read.
+ */
+int health_update(int id, bool good, int value, int full){
+
+	Health* state = health_get(id);	//health of the sensor
+
+	//sensor is not sampled
+	if(state == NULL)
+		return value;
+
+	unsigned long now = millis();	//time of the read
+
+	//keep the last good value
+	if(!good){
+		state->errors++;
+		return state->seen ? state->value : value;
+	}
+
+	//value is sitting at a rail
+	if(full > 0 && (value <= HEALTH_RAIL || value >= full - HEALTH_RAIL) && state->seen && value == state->value){
+		if(state->railed == 0)
+			state->railed = now > 0 ? now : 1;
+		else if(!state->stuck && now - state->railed >= HEALTH_STUCK){
+			state->stuck = true;
+			state->stucks++;
+		}
+	}
+	else{
+		state->railed = 0;
+		state->stuck = false;
+	}
+
+	state->seen = true;
+	state->lastGood = now;
+	state->value = value;
+
+	return value;
+}
+
+/*
+ * Check that a sensor moves while a controller drives its mechanism.
+ * Controllers call this every sample with the value they used and the
+ * output they computed. A sensor that does not change for HEALTH_STALL
+ * ms while the output is at least HEALTH_DRIVE is stalled until it
+ * moves again or the next run is rearmed. This catches a disconnected
+ * encoder, and a mechanism pushing against a hard stop. Only one
+ * controller should watch a sensor at a time.
+ *
+ * @param id The slot of the sensor.
+ * @param value The sensor value used by the controller.
+ * @param output The controller output.
+ * @return If the sensor is healthy and the output can be applied.
+ */
+bool health_watch(int id, int value, int output){
+
+	Health* state = health_get(id);	//health of the sensor
+
+	//sensor is not sampled
+	if(state == NULL)
+		return true;
+
+	unsigned long now = millis();	//time of the sample
+
+	//sensor has moved, or is not being driven
+	if(value != state->watched || abs(output) < HEALTH_DRIVE){
+		state->watched = value;
+		state->moved = now;
+		state->stalled = false;
+	}
+
+	//sensor has not moved under drive
+	else if(!state->stalled && now - state->moved >= HEALTH_STALL){
+		state->stalled = true;
+		state->stalls++;
+	}
+
+	return health_isHealthy(id);
+}
+
+/*
+ * Clear a stall before a new controller run, so a mechanism that
+ * stalled once can be tried again. Stuck and stale sensors stay
+ * unhealthy.
+ *
+ * @param id The slot of the sensor.
+ */
+void health_rearm(int id){
+
+	Health* state = health_get(id);	//health of the sensor
+
+	//sensor is not sampled
+	if(state == NULL)
+		return;
+
+	state->stalled = false;
+	state->moved = millis();
+}
+
+/*
+ * Check if a sensor is healthy. Sensors that are not sampled are not
+ * monitored and are always healthy.
+ *
+ * @param id The slot of the sensor.
+ * @return If the sensor is not stale, stuck or stalled.
+ */
+bool health_isHealthy(int id){
+	return !health_isStale(id) && !health_isStuck(id) && !health_isStalled(id);
+}
+
+/*
+ * Check if a sensor has gone HEALTH_TIMEOUT ms without a good read, or
+ * has failed every read so far. Only the sampler reads are counted, so
+ * no sensor is stale while the sampler is stopped.
+ *
+ * @param id The slot of the sensor.
+ * @return If the sensor is stale.
+ */
+bool health_isStale(int id){
+
+	Health* state = health_get(id);	//health of the sensor
+
+	//sensor is not sampled, or the sampler is not running to read it
+	if(state == NULL || !sampler_isRunning())
+		return false;
+
+	//sensor has never been read
+	if(!state->seen)
+		return state->errors > 0;
+
+	return millis() - state->lastGood > HEALTH_TIMEOUT;
+}
+
+/*
+ * Check if a sensor is stuck at a rail.
+ *
+ * @param id The slot of the sensor.
+ * @return If the sensor is stuck.
+ */
+bool health_isStuck(int id){
+
+	Health* state = health_get(id);	//health of the sensor
+
+	return state != NULL && state->stuck;
+}
+
+/*
+ * Check if a sensor did not move while a controller drove it.
+ *
+ * @param id The slot of the sensor.
+ * @return If the sensor is stalled.
+ */
+bool health_isStalled(int id){
+
+	Health* state = health_get(id);	//health of the sensor
+
+	return state != NULL && state->stalled;
+}
+
+/*
+ * Retrieve the time of the last good read of a sensor.
+ *
+ * @param id The slot of the sensor.
+ * @return The time in ms, 0 if it has not had a good read.
+ */
+unsigned long health_getLastGood(int id){
+
+	Health* state = health_get(id);	//health of the sensor
+
+	return state != NULL && state->seen ? state->lastGood : 0;
+}
+
+/*
+ * Retrieve the value of the last good read of a sensor.
+ *
+ * @param id The slot of the sensor.
+ * @param value The value to use if it has not had a good read.
+ * @return The value of the last good read.
+ */
+int health_getValue(int id, int value){
+
+	Health* state = health_get(id);	//health of the sensor
+
+	return state != NULL && state->seen ? state->value : value;
+}
+
+/*
+ * Retrieve the number of failed reads of a sensor.
+ *
+ * @param id The slot of the sensor.
+ * @return The number of failed reads.
+ */
+unsigned int health_getErrors(int id){
+
+	Health* state = health_get(id);	//health of the sensor
+
+	return state != NULL ? state->errors : 0;
+}
+
+/*
+ * Retrieve the number of faults of every kind of a sensor, which is its
+ * failed reads, the times it stuck and the times it stalled.
+ *
+ * @param id The slot of the sensor.
+ * @return The number of faults.
+ */
+unsigned int health_getFaults(int id){
+
+	Health* state = health_get(id);	//health of the sensor
+
+	return state != NULL ? state->errors + state->stucks + state->stalls : 0;
+}
+
+/*
+ * Retrieve the number of faults of every kind over every monitored
+ * sensor, so a reporter can tell when a new fault has been counted.
+ *
+ * @return The number of faults.
+ */
+unsigned int health_getTotalFaults(){
+
+	unsigned int total = 0;	//faults counted so far
+
+	//count each sensor
+	for(int i = SAMPLER_FIRST; i < healthCount; i++)
+		total += health_getFaults(i);
+
+	return total;
+}
+
+/*
+ * Write the fault counters of every monitored sensor as a single
+ * telemetry line. Each sensor is written as errors/stucks/stalls and
+ * unhealthy sensors are marked with an asterisk.
+ *
+ * @param stream The stream the line is written to.
+ */
+void health_report(FILE* stream){
+
+	fprintf(stream, "HEALTH %d", healthCount > SAMPLER_FIRST ? healthCount - SAMPLER_FIRST : 0);
+
+	//write each sensor
+	for(int i = SAMPLER_FIRST; i < healthCount; i++)
+		fprintf(stream, " %u/%u/%u%s", health[i].errors, health[i].stucks, health[i].stalls, health_isHealthy(i) ? "" : "*");
+
+	fprintf(stream, "\r\n");
+}
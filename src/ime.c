@@ -0,0 +1,243 @@
+/*
+ * @file ime.c
+ *
+ * @brief Implementation of the IME chain manager. A failed read is
+ *		  retried up to IME_RETRIES times. If every attempt fails the
+ *		  last good count is kept and the IME is marked as bad until it
+ *		  is read successfully again.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <ime.h>
+
+static ImeState ime[IME_MAX];					//state of each IME address
+static unsigned int imeSize;					//number of IMEs on the chain
+static bool imeInitialized;						//flag for the chain being initialized
+static unsigned long imeSweeps;				//number of sweeps
+
+/*
+ * Initialize the IME chain if it has not been initialized yet. Every
+ * IME sensor calls this, but the chain is only initialized once.
+ *
+ * @return The number of IMEs on the chain.
+ */
+unsigned int ime_init(){
+
+	//chain is already initialized
+	if(imeInitialized)
+		return imeSize;
+
+	return ime_reinitialize();
+}
+
+/*
+ * Initialize the IME chain, for example after an IME has been plugged
+ * back in. This is not thread safe, so it should only be called while
+ * the sampler is stopped.
+ *
+ * @return The number of IMEs on the chain.
+ */
+unsigned int ime_reinitialize(){
+
+	imeSize = imeInitializeAll();	//number the IMEs on the chain
+	if(imeSize > IME_MAX)
+		imeSize = IME_MAX;
+
+	//forget the cached state
+	for(int i = 0; i < IME_MAX; i++){
+		ime[i].count = 0;
+		ime[i].velocity = velocity_init();
+		ime[i].stamp = 0;
+		ime[i].good = false;
+		ime[i].seen = ime[i].resets;
+	}
+
+	imeInitialized = true;
+	return imeSize;
+}
+
+/*
+ * Check if the IME chain has been initialized.
+ *
+ * @return If the chain has been initialized.
+ */
+bool ime_isInitialized(){
+	return imeInitialized;
+}
+
+/*
+ * Retrieve the number of IMEs found when the chain was initialized.
+ *
+ * @return The number of IMEs on the chain.
+ */
+unsigned int ime_getSize(){
+	return imeSize;
+}
+
+/*
+ * Read every IME on the chain once and update its cached count and
+ * velocity. The sampler calls this once per tick.
+ */
+void ime_sweep(){
+
+	//read each IME
+	for(unsigned int i = 0; i < imeSize; i++){
+		ImeState* state = &ime[i];							//state of the IME
+		unsigned int resets = state->resets;		//resets before the read
+		int value = 0;													//count being read
+		bool good = imeGet(i, &value);					//flag for the read succeeding
+
+		//retry a failed read
+		for(int j = 0; !good && j < IME_RETRIES; j++){
+			state->retries++;
+			good = imeGet(i, &value);
+		}
+
+		//every attempt failed, keep the last good count
+		if(!good){
+			state->errors++;
+			state->good = false;
+			continue;
+		}
+
+		unsigned long now = micros();	//time of the read
+
+		//IME was reset, start the velocity estimate over
+		if(state->seen != resets){
+			velocity_reset(&state->velocity);
+			state->seen = resets;
+		}
+
+		state->count = value;
+		state->stamp = now;
+		state->good = true;
+		velocity_update(&state->velocity, value, now);
+	}
+
+	imeSweeps++;
+}
+
+/*
+ * Reset the count of an IME to zero.
+ *
+ * @param address The IME address.
+ */
+void ime_reset(unsigned char address){
+
+	imeReset(address);
+
+	//address is cached
+	if(address < IME_MAX){
+		ime[address].count = 0;
+		ime[address].resets++;	//restart the velocity estimate on the next sweep
+	}
+}
+
+/*
+ * Retrieve the count of an IME from the last sweep. If the last read
+ * failed this is the last good count.
+ *
+ * @param address The IME address.
+ * @param value Where the count is stored.
+ * @return If the last read of the IME succeeded.
+ */
+bool ime_getCount(unsigned char address, int* value){
+
+	//address is not on the chain
+	if(address >= imeSize)
+		return false;
+
+	*value = ime[address].count;
+	return ime[address].good;
+}
+
+/*
+ * Retrieve the velocity of an IME estimated from its counts.
+ *
+ * @param address The IME address.
+ * @return The velocity in counts per second.
+ */
+int ime_getVelocity(unsigned char address){
+	return address < imeSize ? velocity_get(&ime[address].velocity) : 0;
+}
+
+/*
+ * Retrieve the acceleration of an IME estimated from its counts.
+ *
+ * @param address The IME address.
+ * @return The acceleration in counts per second squared.
+ */
+int ime_getAcceleration(unsigned char address){
+	return address < imeSize ? velocity_getAcceleration(&ime[address].velocity) : 0;
+}
+
+/*
+ * Retrieve the time of the last good read of an IME.
+ *
+ * @param address The IME address.
+ * @return The time in microseconds, 0 if it has never been read.
+ */
+unsigned long ime_getStamp(unsigned char address){
+	return address < imeSize ? ime[address].stamp : 0;
+}
+
+/*
+ * Retrieve the number of reads of an IME that failed after every retry.
+ *
+ * @param address The IME address.
+ * @return The number of failed reads.
+ */
+unsigned int ime_getErrors(unsigned char address){
+	return address < IME_MAX ? ime[address].errors : 0;
+}
+
+/*
+ * Retrieve the number of retried reads of an IME.
+ *
+ * @param address The IME address.
+ * @return The number of retries.
+ */
+unsigned int ime_getRetries(unsigned char address){
+	return address < IME_MAX ? ime[address].retries : 0;
+}
+
+/*
+ * Retrieve the number of sweeps of the chain.
+ *
+ * @return The number of sweeps.
+ */
+unsigned long ime_getSweeps(){
+	return imeSweeps;
+}
+
+/*
+ * Write the error and retry count of every IME on the chain as a
+ * single telemetry line. IMEs whose last read failed are marked with
+ * an asterisk.
+ *
+ * @param stream The stream the line is written to.
+ */
+void ime_report(FILE* stream){
+
+	fprintf(stream, "IME %u", imeSize);
+
+	//write each IME
+	for(unsigned int i = 0; i < imeSize; i++)
+		fprintf(stream, " %u/%u%s", ime[i].errors, ime[i].retries, ime[i].good ? "" : "*");
+
+	fprintf(stream, "\r\n");
+}
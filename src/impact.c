@@ -0,0 +1,322 @@
+/*
+ * @file impact.c
+ *
+ * @brief Implementation of collision and tip detection. Readings are
+ *		  taken straight from the hardware at the detection rate rather
+ *		  than from the sampler snapshot, since a collision is over in a
+ *		  few tens of milliseconds. The gravity estimate is a first order
+ *		  low pass filter, and the fast acceleration is the reading less
+ *		  that estimate, which is the matching high pass filter.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <impact.h>
+
+static const Sensor* impactAxes[3];						//x, y and z axes, NULL for a missing axis
+static int impactOffset[3];										//reading of each axis at zero g
+static int impactScale;												//counts per g
+static Fixed impactGravity[3];								//gravity estimate of each axis in g
+static Fixed impactGain;											//gain of the gravity estimate each step
+static volatile Fixed impactShock;						//fast acceleration magnitude in g
+static volatile Fixed impactTilt;							//tilt from level in degrees
+static int impactLimit = IMPACT_TIP;					//tilt in degrees that is tipping
+static volatile bool impactTipping;						//flag for the robot being tilted past the limit
+static volatile int impactEvents;							//events since the last poll
+static unsigned int impactCollisions;					//number of collisions
+static unsigned int impactTips;								//number of times the robot has tipped
+static unsigned long impactLast;							//time of the last collision in milliseconds
+static void (*impactHandler)(int event);			//function called on each event, NULL for none
+static TaskHandle impactTask;									//detection task, NULL when stopped
+static unsigned long impactPeriod;						//detection period in milliseconds
+
+/*
+ * Set the detection period and the gain of the gravity estimate that
+ * gives it a time constant of IMPACT_TAU.
+ *
+ * @param period The detection period in milliseconds.
+ */
+static void impact_setPeriod(unsigned long period){
+	impactPeriod = period > 0 ? period : IMPACT_PERIOD;
+	impactGain = fixed_saturate(((int64_t)impactPeriod << FIXED_SHIFT) / (IMPACT_TAU + impactPeriod));
+}
+
+/*
+ * Detection task. Reads the accelerometer once per period.
+ *
+ * @param ignore Unused task parameter.
+ */
+static void impact_run(void* ignore){
+
+	unsigned long wake = millis();	//time of the last step
+
+	//detect forever
+	while(true){
+		impact_step();
+		taskDelayUntil(&wake, impactPeriod);
+	}
+}
+
+/*
+ * Report an event to the pollers and the handler.
+ *
+ * @param event The event that happened.
+ */
+static void impact_report(int event){
+	impactEvents |= event;
+
+	//notify the handler
+	if(impactHandler != NULL)
+		impactHandler(event);
+}
+
+/*
+ * Read an axis in g.
+ *
+ * @param axis The axis being read.
+ * @return The acceleration in g, 1 g for a missing z axis and 0 g for another missing axis.
+ */
+static Fixed impact_read(int axis){
+
+	//missing axis, assume the robot is level
+	if(impactAxes[axis] == NULL)
+		return axis == 2 ? FIXED_ONE : 0;
+
+	int value = sensor_readRef(impactAxes[axis]);	//raw reading
+
+	return fixed_saturate(((int64_t)(value - impactOffset[axis]) << FIXED_SHIFT) / impactScale);
+}
+
+/*
+ * Check an accelerometer axis was created, so a sensor that was never
+ * initialized is treated as a missing axis instead of being read.
+ *
+ * @param axis The axis, or NULL.
+ * @return The axis, or NULL if it is missing.
+ */
+static const Sensor* impact_axis(const Sensor* axis){
+	return axis != NULL && axis->size > 0 && axis->ports != NULL ? axis : NULL;
+}
+
+/*
+ * Set the accelerometer axes. Each axis is an ACCEL sensor, the z axis
+ * should point up, and the axes must stay in place while the detector
+ * runs. Axes that were never initialized are missing. The readings at
+ * zero g are taken to be mid scale until the detector is calibrated.
+ *
+ * @param x The x axis, or NULL.
+ * @param y The y axis, or NULL.
+ * @param z The z axis, or NULL.
+ * @param scale The counts per g, IMPACT_SCALE for the 2 g range.
+ */
+void impact_init(const Sensor* x, const Sensor* y, const Sensor* z, int scale){
+	impactAxes[0] = impact_axis(x);
+	impactAxes[1] = impact_axis(y);
+	impactAxes[2] = impact_axis(z);
+	impactScale = scale > 0 ? scale : IMPACT_SCALE;
+	impact_setPeriod(IMPACT_PERIOD);
+
+	//start level
+	for(int i = 0; i < 3; i++){
+		impactOffset[i] = 2048;
+		impactGravity[i] = i == 2 ? FIXED_ONE : 0;
+	}
+}
+
+/*
+ * Measure the readings at zero g by averaging the axes while the robot
+ * is still and level, which takes IMPACT_SAMPLES detection periods.
+ * The z axis reads one g when level, so its zero is one g below. Does
+ * nothing if every axis is missing.
+ */
+void impact_calibrate(){
+
+	int64_t sums[3] = {0, 0, 0};	//sum of the readings of each axis
+
+	//no accelerometer to calibrate
+	if(impactAxes[0] == NULL && impactAxes[1] == NULL && impactAxes[2] == NULL)
+		return;
+
+	//average the readings
+	for(int i = 0; i < IMPACT_SAMPLES; i++){
+		for(int j = 0; j < 3; j++)
+			if(impactAxes[j] != NULL)
+				sums[j] += sensor_readRef(impactAxes[j]);
+		delay(IMPACT_PERIOD);
+	}
+
+	//set the zeros and start level
+	for(int i = 0; i < 3; i++){
+		impactOffset[i] = sums[i] / IMPACT_SAMPLES - (i == 2 ? impactScale : 0);
+		impactGravity[i] = i == 2 ? FIXED_ONE : 0;
+	}
+
+	impactTilt = 0;
+	impactTipping = false;
+}
+
+/*
+ * Start the detection task. Does nothing if it is already running or
+ * the axes have not been set.
+ *
+ * @param period The detection period in milliseconds.
+ */
+void impact_start(unsigned long period){
+	impact_setPeriod(period);	//set the period
+
+	//start the task
+	if(impactTask == NULL && (impactAxes[0] != NULL || impactAxes[1] != NULL || impactAxes[2] != NULL))
+		impactTask = taskCreate(impact_run, TASK_DEFAULT_STACK_SIZE, NULL, TASK_PRIORITY_DEFAULT + 1);
+}
+
+/*
+ * Stop the detection task. Events are no longer reported.
+ */
+void impact_stop(){
+
+	//stop the task
+	if(impactTask != NULL){
+		taskDelete(impactTask);
+		impactTask = NULL;
+	}
+}
+
+/*
+ * Read the accelerometer, update the gravity estimate and report any
+ * new collision or tip. The detection task calls this every period.
+ */
+void impact_step(){
+
+	Fixed shock = 0;	//sum of the squared fast accelerations
+
+	//split each axis into gravity and fast acceleration
+	for(int i = 0; i < 3; i++){
+		Fixed value = impact_read(i);	//acceleration of the axis
+		impactGravity[i] += fixed_mul(impactGain, value - impactGravity[i]);
+		Fixed fast = value - impactGravity[i];
+		shock = fixed_saturate((int64_t)shock + fixed_mul(fast, fast));
+	}
+
+	Fixed horizontal = trig_sqrt(fixed_mul(impactGravity[0], impactGravity[0]) + fixed_mul(impactGravity[1], impactGravity[1]));	//gravity across the robot
+
+	impactShock = trig_sqrt(shock);
+	impactTilt = trig_atan2(horizontal, impactGravity[2]);
+
+	unsigned long now = millis();	//time of the step
+
+	//robot hit something
+	if(impactShock >= IMPACT_SHOCK && (impactCollisions == 0 || now - impactLast >= IMPACT_HOLDOFF)){
+		impactCollisions++;
+		impactLast = now;
+		impact_report(IMPACT_COLLISION);
+	}
+
+	//robot has tipped past the limit
+	if(!impactTipping && impactTilt >= fixed_fromInt(impactLimit)){
+		impactTipping = true;
+		impactTips++;
+		impact_report(IMPACT_TIPPING);
+	}
+
+	//robot has recovered
+	else if(impactTipping && impactTilt < fixed_fromInt(impactLimit - IMPACT_RECOVER))
+		impactTipping = false;
+}
+
+/*
+ * Set the function called on each event. The handler runs in the
+ * detection task, so it should only set flags or stop motors.
+ *
+ * @param handler The function called with the event, NULL for none.
+ */
+void impact_setHandler(void (*handler)(int event)){
+	impactHandler = handler;
+}
+
+/*
+ * Set the tilt that is tipping, for example lower while a lift is
+ * raised and the robot is top heavy.
+ *
+ * @param degrees The tilt from level in degrees.
+ */
+void impact_setTipLimit(int degrees){
+	impactLimit = degrees > IMPACT_RECOVER ? degrees : IMPACT_RECOVER + 1;
+}
+
+/*
+ * Retrieve the events since the last poll and clear them.
+ *
+ * @return The events, IMPACT_COLLISION and IMPACT_TIPPING or-ed together.
+ */
+int impact_poll(){
+	int events = impactEvents;	//events being retrieved
+	impactEvents &= ~events;
+	return events;
+}
+
+/*
+ * Check if the robot is tilted past the tip limit.
+ *
+ * @return If the robot is tipping.
+ */
+bool impact_isTipping(){
+	return impactTipping;
+}
+
+/*
+ * Retrieve the magnitude of the fast acceleration.
+ *
+ * @return The fixed-point magnitude in g.
+ */
+Fixed impact_getShock(){
+	return impactShock;
+}
+
+/*
+ * Retrieve the tilt of the robot from level.
+ *
+ * @return The fixed-point tilt in degrees.
+ */
+Fixed impact_getTilt(){
+	return impactTilt;
+}
+
+/*
+ * Retrieve the number of collisions.
+ *
+ * @return The number of collisions.
+ */
+unsigned int impact_getCollisions(){
+	return impactCollisions;
+}
+
+/*
+ * Retrieve the number of times the robot has tipped.
+ *
+ * @return The number of tips.
+ */
+unsigned int impact_getTips(){
+	return impactTips;
+}
+
+/*
+ * Retrieve the time of the last collision.
+ *
+ * @return The time in milliseconds, 0 if there has not been one.
+ */
+unsigned long impact_getLastCollision(){
+	return impactLast;
+}
@@ -1,4 +1,6 @@
 #include "main.h"
+#include <pool.h>
+#include <button.h>
 
 void initializeIO() {
 
@@ -22,7 +24,19 @@ void initialize() {
  	Robot.leftDrive = motorSystem_init(2, &m1, &m2);
  	Robot.rightDrive = motorSystem_init(2, &m3, &m4);
 
+	//motor pool ran out, the drive is left empty rather than lopsided
+	if(motorSystem_getSizeRef(&Robot.leftDrive) == 0 || motorSystem_getSizeRef(&Robot.rightDrive) == 0)
+		printf("DRIVE missing motors\r\n");
+
+	robot_startOdometry();	//track the pose once the drive sensors are set up
+	robot_startImpact();		//detect collisions and tipping once the accelerometer is set up
+	robot_startMonitor();		//report temperatures and sensor faults once the drive is set up
+
+	pool_report(stdout);		//report memmory pool usage
+
 	//LCD
 	Robot.lcd = lcd_init(uart2);    //setup the robot's lcd
+	lcd_start(&Robot.lcd, LCD_PERIOD);	//send lcd changes in the background
+	button_start(Robot.lcd.port, BUTTON_PERIOD);	//debounce the lcd buttons in the background
 	robot_lcdMenu();                //begin robot start up menu
 }
@@ -0,0 +1,328 @@
+/*
+ * @file line.c
+ *
+ * @brief Implementation of line sensor array tracking. Sensors are read
+ *		  straight from the hardware by the line task, since a sensor
+ *		  crosses a strip of tape in a few tens of milliseconds. Each
+ *		  reading widens the range the sensor has seen, and a sensor only
+ *		  reports the line once that range is wide enough to trust.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <line.h>
+
+static LineArray* lineArrays[LINE_ARRAYS];	//arrays sampled by the line task
+static volatile int lineCount;							//number of arrays sampled by the line task
+static TaskHandle lineTask;									//line task, NULL when stopped
+static unsigned long linePeriod;						//sample period in milliseconds
+
+/*
+ * Line task. Samples every array once per period.
+ *
+ * @param ignore Unused task parameter.
+ */
+static void line_run(void* ignore){
+
+	unsigned long wake = millis();	//time of the last sample
+
+	//sample forever
+	while(true){
+		for(int i = 0; i < lineCount; i++)
+			line_step(lineArrays[i]);
+		taskDelayUntil(&wake, linePeriod);
+	}
+}
+
+/*
+ * Push an edge event into the buffer of an array.
+ *
+ * @param array The array the event happened on.
+ * @param sensor The index of the sensor.
+ * @param on If the sensor reached the line rather than left it.
+ * @param stamp The time of the event in microseconds.
+ */
+static void line_push(LineArray* array, int sensor, bool on, unsigned long stamp){
+
+	unsigned int head = array->head;	//position being pushed to
+
+	//buffer is full
+	if(head - array->tail >= LINE_EVENTS){
+		array->dropped++;
+		return;
+	}
+
+	LineEvent* event = &array->events[head & (LINE_EVENTS - 1)];	//event being pushed
+	event->sensor = sensor;
+	event->on = on;
+	event->stamp = stamp;
+
+	array->head = head + 1;	//publish the event once it is written
+}
+
+/*
+ * Set the sensors of a line sensor array. The sensors are given from
+ * left to right and must stay in place while the array is sampled.
+ *
+ * @param sensors The number of sensors, up to LINE_SENSORS.
+ * @param dark If the line is darker than the floor, false for white tape on grey tiles.
+ * @param sensor The leftmost sensor.
+ * @param ... The rest of the sensors.
+ * @return The array being initialized.
+ */
+LineArray line_init(int sensors, bool dark, const Sensor* sensor, ...){
+
+	va_list param;						//create list of parameters
+	va_start(param, sensor);	//start list of parameters
+
+	LineArray tmp;																								//array being returned
+	tmp.size = sensors < 0 ? 0 : sensors > LINE_SENSORS ? LINE_SENSORS : sensors;	//number of sensors
+	tmp.dark = dark;																							//line polarity
+
+	//assign sensors
+	for(int i = 0; i < tmp.size; i++){
+		tmp.sensors[i] = sensor;
+		if(i + 1 < tmp.size)
+			sensor = va_arg(param, const Sensor*);	//get the next sensor
+	}
+
+	va_end(param);	//end the list of parameters
+
+	line_calibrate(&tmp);	//nothing seen yet
+	tmp.head = 0;					//no events
+	tmp.tail = 0;
+	tmp.dropped = 0;
+
+	return tmp;
+}
+
+/*
+ * Forget the lightest and darkest readings of every sensor, for
+ * example after moving to a field with different lighting. Sensors
+ * do not report the line until they have seen it again.
+ *
+ * @param array The array being calibrated.
+ */
+void line_calibrate(LineArray* array){
+
+	//start with an empty range
+	for(int i = 0; i < array->size; i++){
+		array->lightest[i] = 0xFFFF;
+		array->darkest[i] = 0;
+		array->levels[i] = 0;
+		array->stamps[i] = 0;
+	}
+
+	array->on = 0;
+	array->position = 0;
+	array->found = false;
+}
+
+/*
+ * Sample every sensor of an array, widen the range each has seen,
+ * normalise the readings and report any sensor that has reached or
+ * left the line. The line task calls this every period, it can also
+ * be called directly when the task is not running.
+ *
+ * @param array The array being sampled.
+ */
+void line_step(LineArray* array){
+
+	unsigned long now = micros();					//time of the sample
+	unsigned int on = array->on;					//sensors over the line
+	int offset = (array->size - 1) * LINE_SPACING / 2;	//position of the leftmost sensor from the middle
+	int64_t sum = 0;											//sum of the weighted sensor positions
+	int64_t total = 0;										//sum of the weights
+
+	//sample each sensor
+	for(int i = 0; i < array->size; i++){
+		int value = sensor_readRef(array->sensors[i]);	//raw reading
+		unsigned int bit = 1u << i;											//bit of the sensor
+
+		//widen the range
+		if(value < array->lightest[i])
+			array->lightest[i] = value;
+		if(value > array->darkest[i])
+			array->darkest[i] = value;
+
+		int range = array->darkest[i] - array->lightest[i];	//range the sensor has seen
+		int level = 0;																			//normalised level
+
+		//sensor has seen both the line and the floor
+		if(range >= LINE_CONTRAST)
+			level = (array->dark ? value - array->lightest[i] : array->darkest[i] - value) * LINE_FULL / range;
+		array->levels[i] = level;
+
+		//sensor has reached the line
+		if(!(on & bit) && level >= LINE_ON){
+			on |= bit;
+			array->stamps[i] = now;
+			line_push(array, i, true, now);
+		}
+
+		//sensor has left the line
+		else if((on & bit) && level <= LINE_OFF){
+			on &= ~bit;
+			line_push(array, i, false, now);
+		}
+
+		//weight the sensor position by how far it is over the line
+		if(level > LINE_FLOOR){
+			sum += (int64_t)(level - LINE_FLOOR) * (i * LINE_SPACING - offset);
+			total += level - LINE_FLOOR;
+		}
+	}
+
+	array->on = on;
+	array->found = on != 0;
+
+	//line is under the array, otherwise keep the last position
+	if(total > 0)
+		array->position = sum / total;
+}
+
+/*
+ * Sample an array in the line task, starting the task if it is not
+ * running. Every array in the task is sampled at the latest period.
+ *
+ * @param array The array being sampled.
+ * @param period The sample period in milliseconds.
+ * @return If the array is sampled by the task.
+ */
+bool line_start(LineArray* array, unsigned long period){
+
+	linePeriod = period > 0 ? period : LINE_PERIOD;	//set the period
+	bool added = false;															//flag for the array being in the task
+
+	//array is already sampled
+	for(int i = 0; i < lineCount; i++)
+		if(lineArrays[i] == array)
+			added = true;
+
+	//add the array
+	if(!added && lineCount < LINE_ARRAYS){
+		lineArrays[lineCount] = array;
+		lineCount++;
+		added = true;
+	}
+
+	//start the task
+	if(lineTask == NULL)
+		lineTask = taskCreate(line_run, TASK_DEFAULT_STACK_SIZE, NULL, TASK_PRIORITY_DEFAULT + 1);
+
+	return added;
+}
+
+/*
+ * Stop the line task and remove every array from it.
+ */
+void line_stop(){
+
+	//stop the task
+	if(lineTask != NULL){
+		taskDelete(lineTask);
+		lineTask = NULL;
+	}
+
+	lineCount = 0;
+}
+
+/*
+ * Check if a sensor has seen enough of the line and the floor to
+ * report the line.
+ *
+ * @param array The array being accessed.
+ * @param index The index of the sensor.
+ * @return If the sensor is calibrated.
+ */
+bool line_isCalibrated(const LineArray* array, int index){
+	return index >= 0 && index < array->size && array->darkest[index] - array->lightest[index] >= LINE_CONTRAST;
+}
+
+/*
+ * Check if any sensor of an array is over the line.
+ *
+ * @param array The array being accessed.
+ * @return If the line is under the array.
+ */
+bool line_isFound(const LineArray* array){
+	return array->found;
+}
+
+/*
+ * Check if a sensor is over the line.
+ *
+ * @param array The array being accessed.
+ * @param index The index of the sensor.
+ * @return If the sensor is over the line.
+ */
+bool line_isOn(const LineArray* array, int index){
+	return index >= 0 && index < array->size && (array->on & (1u << index));
+}
+
+/*
+ * Retrieve the centroid of the line under an array, weighted by how far
+ * each sensor is over the line. Once the line is lost this is where it
+ * was last seen.
+ *
+ * @param array The array being accessed.
+ * @return The position in LINE_SPACING units per sensor, 0 under the middle and positive to the right.
+ */
+int line_getPosition(const LineArray* array){
+	return array->position;
+}
+
+/*
+ * Retrieve the time a sensor last reached the line. Comparing the
+ * times of the outer sensors shows the angle the array crossed it at.
+ *
+ * @param array The array being accessed.
+ * @param index The index of the sensor.
+ * @return The time in microseconds, 0 if it has not reached the line.
+ */
+unsigned long line_getStamp(const LineArray* array, int index){
+	return index >= 0 && index < array->size ? array->stamps[index] : 0;
+}
+
+/*
+ * Take the oldest edge event of an array.
+ *
+ * @param array The array being accessed.
+ * @param event Where the event is stored.
+ * @return If there was an event.
+ */
+bool line_pop(LineArray* array, LineEvent* event){
+
+	unsigned int tail = array->tail;	//position being popped from
+
+	//buffer is empty
+	if(tail == array->head)
+		return false;
+
+	*event = array->events[tail & (LINE_EVENTS - 1)];
+	array->tail = tail + 1;	//free the event once it is copied
+
+	return true;
+}
+
+/*
+ * Discard every edge event of an array.
+ *
+ * @param array The array being accessed.
+ */
+void line_flush(LineArray* array){
+	array->tail = array->head;
+}
@@ -0,0 +1,168 @@
+/*
+ * @file linear.c
+ *
+ * @brief Implementation of the motor response linearisation tables.
+ *		  Each table holds the command for every proportional speed from
+ *		  0 to 127 and is applied symmetrically for negative speeds.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <linear.h>
+
+static LinearTable linearTypes[MOTOR_RAW];	//default table of each motor type
+
+/*
+ * Build the default table for every motor type.
+ */
+void linear_init(){
+	linear_setModel(MOTOR_393, LINEAR_393_DEADBAND, LINEAR_393_SATURATION);
+	linear_setModel(MOTOR_269, LINEAR_269_DEADBAND, LINEAR_269_SATURATION);
+}
+
+/*
+ * Build the default table for a motor type from a model of its
+ * response. The motor does not move up to the deadband, reaches 90% of
+ * full speed linearly at the saturation command, then gains the last
+ * 10% linearly up to full command.
+ *
+ * @param type The motor type.
+ * @param deadband The largest command that does not move the motor.
+ * @param saturation The command that reaches 90% of full speed.
+ */
+void linear_setModel(int type, int deadband, int saturation){
+
+	//motor type is not linearised
+	if(type < 0 || type >= MOTOR_RAW)
+		return;
+
+	int speeds[128];	//modelled speed for each command in thousandths of full speed
+
+	//keep the model in range
+	if(deadband < 0)
+		deadband = 0;
+	if(saturation <= deadband)
+		saturation = deadband + 1;
+	if(saturation > 126)
+		saturation = 126;
+
+	//model the response
+	for(int i = 0; i < 128; i++){
+		if(i <= deadband)
+			speeds[i] = 0;
+		else if(i <= saturation)
+			speeds[i] = 900 * (i - deadband) / (saturation - deadband);
+		else
+			speeds[i] = 900 + 100 * (i - saturation) / (127 - saturation);
+	}
+
+	linear_setResponse(&linearTypes[type], speeds);
+}
+
+/*
+ * Build a table from the speed measured for every command from 0 to
+ * 127, for example during a calibration run. Speeds may be in any unit
+ * but must rise with the command. A response that never moves, or that
+ * falls by more than LINEAR_NOISE percent of the fastest speed, comes
+ * from a stalled mechanism or a bad sensor and is rejected.
+ *
+ * @param table The table being built, unchanged if the response is rejected.
+ * @param speeds The measured speed for each command.
+ * @return If the table was built.
+ */
+bool linear_setResponse(LinearTable* table, const int* speeds){
+
+	int fastest = 0;	//largest measured speed
+	for(int i = 0; i < 128; i++)
+		if(speeds[i] > fastest)
+			fastest = speeds[i];
+
+	//motor never moved
+	if(fastest <= 0)
+		return false;
+
+	int noise = fastest * LINEAR_NOISE / 100;	//largest drop allowed for measurement noise
+	int peak = 0;															//fastest speed up to each command
+
+	//response must rise with the command
+	for(int i = 0; i < 128; i++){
+		if(speeds[i] < peak - noise)
+			return false;
+		if(speeds[i] > peak)
+			peak = speeds[i];
+	}
+
+	int command = 0;	//smallest command that reaches the speed being searched for
+	int reached = 0;	//largest speed reached up to the command, so noise can not reverse the table
+
+	table->commands[0] = 0;	//zero is always zero
+
+	//find the command for each proportional speed
+	for(int i = 1; i < 128; i++){
+		int64_t target = (int64_t)fastest * i;	//desired speed scaled by 127
+
+		while(command < 127 && (int64_t)reached * 127 < target){
+			command++;
+			if(speeds[command] > reached)
+				reached = speeds[command];
+		}
+
+		table->commands[i] = command;
+	}
+
+	table->ready = true;
+	return true;
+}
+
+/*
+ * Map a proportional velocity to the motor command that produces it,
+ * using the default table of a motor type.
+ *
+ * @param type The motor type.
+ * @param velocity The proportional velocity from -127 to 127.
+ * @return The motor command.
+ */
+int linear_apply(int type, int velocity){
+
+	//motor type is not linearised
+	if(type < 0 || type >= MOTOR_RAW)
+		return velocity;
+
+	return linear_applyTable(&linearTypes[type], velocity);
+}
+
+/*
+ * Map a proportional velocity to the motor command that produces it
+ * using a table.
+ *
+ * @param table The table, NULL for none.
+ * @param velocity The proportional velocity from -127 to 127.
+ * @return The motor command.
+ */
+int linear_applyTable(const LinearTable* table, int velocity){
+
+	//velocity is out of range
+	if(velocity > 127)
+		velocity = 127;
+	else if(velocity < -127)
+		velocity = -127;
+
+	//no table to apply
+	if(table == NULL || !table->ready)
+		return velocity;
+
+	return velocity < 0 ? -table->commands[-velocity] : table->commands[velocity];
+}
@@ -0,0 +1,239 @@
+/*
+ * @file odometry.c
+ *
+ * @brief Implementation of the odometry task. Each step moves the pose
+ *		  by the average of the two encoder deltas along the heading
+ *		  halfway through the step. The pose is published through a
+ *		  pair of buffers, so a reader always gets a whole pose without
+ *		  locking out the task. With a gyro, the heading comes from the
+ *		  complementary heading estimator.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <odometry.h>
+
+#define ODOMETRY_DEGREES FIXED(57.29578)	//degrees in a radian
+
+static const Sensor* odometryLeft;			//left drive encoder
+static const Sensor* odometryRight;			//right drive encoder
+static const Sensor* odometryGyro;			//gyro, NULL to take the heading from the encoders
+static int odometryTrack;								//distance between the drive wheels in encoder counts
+static int odometryLastLeft;						//left encoder count at the last step
+static int odometryLastRight;						//right encoder count at the last step
+static int odometryLastGyro;						//gyro heading at the last step
+static Pose odometryPose;								//pose being integrated
+static volatile Pose odometryPending;		//pose set since the last step, guarded by odometrySequence
+static Heading odometryHeading;					//heading estimator fusing the gyro and encoders
+static Pose odometryBuffers[2];					//published poses
+static volatile int odometryFront;			//index of the latest published pose
+static volatile unsigned int odometrySequence;	//number of pose writes started and finished, odd while one is in progress
+static unsigned int odometryTaken;			//sequence of the last pose taken by a step
+static TaskHandle odometryTask;					//odometry task, NULL when stopped
+static unsigned long odometryPeriod;		//integration period in milliseconds
+
+/*
+ * Publish the integrated pose.
+ */
+static void odometry_publish(){
+	odometryBuffers[!odometryFront] = odometryPose;	//fill the back pose
+	odometryFront = !odometryFront;									//make it the latest
+}
+
+/*
+ * Odometry task. Integrates the pose once per period.
+ *
+ * @param ignore Unused task parameter.
+ */
+static void odometry_run(void* ignore){
+
+	unsigned long wake = millis();	//time of the last step
+
+	//integrate forever
+	while(true){
+		odometry_step();
+		taskDelayUntil(&wake, odometryPeriod);
+	}
+}
+
+/*
+ * Set the sensors the pose is integrated from and set the pose to
+ * zero. The sensors must stay in place while the odometry runs.
+ *
+ * @param left The left drive encoder.
+ * @param right The right drive encoder.
+ * @param gyro The gyro, or NULL to take the heading from the encoders.
+ * @param track The distance between the drive wheels in encoder counts.
+ */
+void odometry_init(const Sensor* left, const Sensor* right, const Sensor* gyro, int track){
+	odometryLeft = left;
+	odometryRight = right;
+	odometryGyro = gyro;
+	odometryTrack = track > 0 ? track : 1;
+	odometryHeading = heading_init(0);
+	odometry_setPose(0, 0, 0);
+}
+
+/*
+ * Start the odometry task. Does nothing if it is already running or
+ * the sensors have not been set.
+ *
+ * @param period The integration period in milliseconds.
+ */
+void odometry_start(unsigned long period){
+	odometryPeriod = period > 0 ? period : ODOMETRY_PERIOD;	//set the period
+
+	//start the task
+	if(odometryTask == NULL && odometryLeft != NULL && odometryRight != NULL)
+		odometryTask = taskCreate(odometry_run, TASK_DEFAULT_STACK_SIZE, NULL, TASK_PRIORITY_DEFAULT + 1);
+}
+
+/*
+ * Stop the odometry task. The pose keeps its last value.
+ */
+void odometry_stop(){
+
+	//stop the task
+	if(odometryTask != NULL){
+		taskDelete(odometryTask);
+		odometryTask = NULL;
+	}
+}
+
+/*
+ * Integrate the sensor changes since the last step into the pose. The
+ * odometry task calls this every period, it can also be called
+ * directly when the task is not running.
+ */
+void odometry_step(){
+
+	int left = sensor_getValueRef(odometryLeft);			//left encoder count
+	int right = sensor_getValueRef(odometryRight);		//right encoder count
+	int gyro = odometryGyro != NULL ? sensor_getValueRef(odometryGyro) : 0;	//gyro heading
+
+	unsigned int sequence = odometrySequence;	//pose writes so far
+
+	//pose was set and is not being written, start integrating from here
+	if(sequence != odometryTaken && !(sequence & 1)){
+		Pose pending = odometryPending;	//copy of the pose being taken
+
+		//pose was written again during the copy, take it next step
+		if(odometrySequence != sequence)
+			return;
+
+		odometryTaken = sequence;
+		odometryPose = pending;
+		heading_set(&odometryHeading, pending.heading);
+		odometryLastLeft = left;
+		odometryLastRight = right;
+		odometryLastGyro = gyro;
+		odometry_publish();
+		return;
+	}
+
+	int dl = left - odometryLastLeft;		//left wheel travel
+	int dr = right - odometryLastRight;	//right wheel travel
+	Fixed turn = fixed_saturate((int64_t)(dr - dl) * ODOMETRY_DEGREES / odometryTrack);	//change in heading from the wheel travel
+
+	//fuse the gyro with the encoder heading
+	if(odometryGyro != NULL)
+		turn = heading_update(&odometryHeading, fixed_fromInt(gyro - odometryLastGyro), turn, dl != 0 || dr != 0) - odometryPose.heading;
+
+	Fixed distance = fixed_fromInt(dl + dr) / 2;							//travel of the middle of the robot
+	Fixed heading = odometryPose.heading + turn / 2;					//heading halfway through the step
+
+	odometryPose.x += fixed_mul(distance, trig_cos(heading));
+	odometryPose.y += fixed_mul(distance, trig_sin(heading));
+	odometryPose.heading += turn;
+	odometryPose.stamp = millis();
+
+	odometryLastLeft = left;
+	odometryLastRight = right;
+	odometryLastGyro = gyro;
+
+	odometry_publish();
+}
+
+/*
+ * Set the current pose, for example at the start of an autonomous
+ * routine. The odometry task takes the pose on its next step, so it
+ * is the only writer of the pose. The sequence is odd while the pose
+ * is written, so a step that runs part way through the write leaves
+ * it for the next step instead of taking half of it. Only one task
+ * should set the pose.
+ *
+ * @param x The fixed-point x position in encoder counts.
+ * @param y The fixed-point y position in encoder counts.
+ * @param heading The fixed-point heading in degrees.
+ */
+void odometry_setPose(Fixed x, Fixed y, Fixed heading){
+	odometrySequence++;	//start the write
+	odometryPending.x = x;
+	odometryPending.y = y;
+	odometryPending.heading = heading;
+	odometryPending.stamp = millis();
+	odometrySequence++;	//finish the write
+
+	//take the pose now when the task is not running
+	if(odometryTask == NULL && odometryLeft != NULL && odometryRight != NULL)
+		odometry_step();
+}
+
+/*
+ * Retrieve the latest pose.
+ *
+ * @return The pose.
+ */
+Pose odometry_getPose(){
+	return odometryBuffers[odometryFront];
+}
+
+/*
+ * Retrieve the latest x position.
+ *
+ * @return The fixed-point x position in encoder counts.
+ */
+Fixed odometry_getX(){
+	return odometryBuffers[odometryFront].x;
+}
+
+/*
+ * Retrieve the latest y position.
+ *
+ * @return The fixed-point y position in encoder counts.
+ */
+Fixed odometry_getY(){
+	return odometryBuffers[odometryFront].y;
+}
+
+/*
+ * Retrieve the latest heading.
+ *
+ * @return The fixed-point heading in degrees.
+ */
+Fixed odometry_getHeading(){
+	return odometryBuffers[odometryFront].heading;
+}
+
+/*
+ * Retrieve the gyro drift learned by the heading estimator while the
+ * robot was still.
+ *
+ * @return The fixed-point drift in degrees per step.
+ */
+Fixed odometry_getGyroBias(){
+	return heading_getBias(&odometryHeading);
+}
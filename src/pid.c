@@ -0,0 +1,332 @@
+/*
+ * @file pid.c
+ *
+ * @brief Implementation of the PID controller. The integral and
+ *		  derivative terms are discrete, meaning the gains are applied
+ *		  per sample, so the controller must be updated once every
+ *		  sample period for the gains to behave consistently. All of the
+ *		  math is done in Q16.16 fixed-point.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <pid.h>
+
+/*
+ * Initialize the pid controller with the default limits, sample
+ * period and settle thresholds.
+ *
+ * @param kP The fixed-point proportional gain.
+ * @param kI The fixed-point integral gain.
+ * @param kD The fixed-point derivative gain.
+ * @return The pid controller being initialized.
+ */
+PID pid_init(Fixed kP, Fixed kI, Fixed kD){
+	PID tmp;																							//pid controller being returned
+	tmp.kP = kP;																					//set proportional gain
+	tmp.kI = kI;																					//set integral gain
+	tmp.kD = kD;																					//set derivative gain
+	tmp.target = 0;																				//set the target to zero
+	pid_setLimits(&tmp, -127, 127, 127);									//limit to the motor range
+	pid_setFilter(&tmp, 0);																//no derivative filtering
+	pid_setPeriod(&tmp, PID_PERIOD);											//set default sample period
+	pid_setSettle(&tmp, PID_SETTLE_ERROR, PID_SETTLE_VELOCITY, PID_SETTLE_SAMPLES);
+	pid_setTimeout(&tmp, PID_TIMEOUT);										//set default timeout
+	pid_clearStats(&tmp);																	//clear statistics
+	pid_reset(&tmp);																			//start a fresh run
+
+	return tmp;
+}
+
+/*
+ * Set the output and integral limits of the controller.
+ *
+ * @param pid The pid controller being manipulated.
+ * @param outMin The minimum output of the controller.
+ * @param outMax The maximum output of the controller.
+ * @param integralMax The maximum magnitude of the integral term.
+ */
+void pid_setLimits(PID* pid, int outMin, int outMax, int integralMax){
+	pid->outMin = outMin;
+	pid->outMax = outMax;
+	pid->integralMax = fixed_fromInt(abs(integralMax));
+}
+
+/*
+ * Set the derivative low pass filter coefficient. Zero disables
+ * filtering and values closer to one filter more heavily.
+ *
+ * @param pid The pid controller being manipulated.
+ * @param dFilter The fixed-point filter coefficient between zero and one.
+ */
+void pid_setFilter(PID* pid, Fixed dFilter){
+	pid->dFilter = fixed_clamp(dFilter, 0, FIXED(0.99));	//one would freeze the derivative
+}
+
+/*
+ * Set the sample period of the controller.
+ *
+ * @param pid The pid controller being manipulated.
+ * @param period The sample period in milliseconds.
+ */
+void pid_setPeriod(PID* pid, unsigned long period){
+	pid->period = period > 0 ? period : 1;
+}
+
+/*
+ * Set the thresholds used to decide when a run has settled.
+ *
+ * @param pid The pid controller being manipulated.
+ * @param error The error band in sensor units.
+ * @param velocity The velocity band in sensor units per sample.
+ * @param samples The number of consecutive samples that must be in both bands.
+ */
+void pid_setSettle(PID* pid, int error, int velocity, int samples){
+	pid->settleError = abs(error);
+	pid->settleVelocity = abs(velocity);
+	pid->settleSamples = samples > 0 ? samples : 1;
+}
+
+/*
+ * Set how long a run may take before it is abandoned.
+ *
+ * @param pid The pid controller being manipulated.
+ * @param timeout The timeout in milliseconds, zero for no timeout.
+ */
+void pid_setTimeout(PID* pid, unsigned long timeout){
+	pid->timeout = timeout;
+}
+
+/*
+ * Set the target of the controller. A new run is started
+ * if the target has changed.
+ *
+ * @param pid The pid controller being manipulated.
+ * @param target The new target value.
+ */
+void pid_setTarget(PID* pid, int target){
+
+	//target has changed
+	if(pid->target != target){
+		pid->target = target;	//set the new target
+		pid_reset(pid);				//start a new run
+	}
+}
+
+/*
+ * Move the target of the controller without starting a new run.
+ * This is used to follow a motion profile, so the run can not
+ * settle until the target stops moving.
+ *
+ * @param pid The pid controller being manipulated.
+ * @param target The new target value.
+ */
+void pid_moveTarget(PID* pid, int target){
+
+	//target has moved
+	if(pid->target != target){
+		pid->target = target;		//set the new target
+		pid->settled = false;		//not settled while moving
+		pid->settledCount = 0;	//restart settle detection
+	}
+}
+
+/*
+ * Restart the current run, clearing the integral, derivative
+ * and settle state.
+ *
+ * @param pid The pid controller being manipulated.
+ */
+void pid_reset(PID* pid){
+	pid->integral = 0;
+	pid->derivative = 0;
+	pid->output = 0;
+	pid->first = true;
+	pid->settled = false;
+	pid->settledCount = 0;
+	pid->samples = 0;
+	pid->overshoot = 0;
+	pid->direction = 1;
+}
+
+/*
+ * Run one sample of the controller. This should be called once
+ * every sample period.
+ *
+ * @param pid The pid controller being manipulated.
+ * @param value The current sensor value.
+ * @return The output of the controller.
+ */
+int pid_update(PID* pid, int value){
+
+	int error = pid->target - value;	//error for this sample
+	int velocity = 0;									//sensor change since the last sample
+
+	//first sample has no previous value
+	if(pid->first){
+		pid->first = false;
+		pid->direction = error < 0 ? -1 : 1;	//direction the system is approaching from
+	}
+	else
+		velocity = value - pid->lastValue;
+
+	pid->lastValue = value;	//save value for the next sample
+	pid->samples++;					//count the sample
+
+	//accumulate and clamp the integral term
+	pid->integral = fixed_add(pid->integral, fixed_mulInt(pid->kI, error));
+	pid->integral = fixed_clamp(pid->integral, -pid->integralMax, pid->integralMax);
+
+	//filtered derivative on the measurement so target changes do not kick
+	pid->derivative = fixed_sub(fixed_mul(pid->dFilter, pid->derivative),
+	                            fixed_mulInt(fixed_mul(FIXED_ONE - pid->dFilter, pid->kD), velocity));
+
+	Fixed output = fixed_add(fixed_add(fixed_mulInt(pid->kP, error), pid->integral), pid->derivative);	//unclamped output
+
+	pid->output = fixed_toInt(fixed_clamp(output, fixed_fromInt(pid->outMin), fixed_fromInt(pid->outMax)));	//clamp output
+
+	//track how far the system has gone past the target
+	if(-error * pid->direction > pid->overshoot)
+		pid->overshoot = -error * pid->direction;
+
+	//settle detection
+	if(!pid->settled){
+
+		//inside both bands
+		if(abs(error) <= pid->settleError && abs(velocity) <= pid->settleVelocity)
+			pid->settledCount++;
+		else
+			pid->settledCount = 0;
+
+		//run has settled
+		if(pid->settledCount >= pid->settleSamples){
+			pid->settled = true;
+			pid->settleTime = pid->samples * pid->period;
+			pid->totalTime += pid->settleTime;
+			pid->runs++;
+
+			//new worst settle time
+			if(pid->settleTime > pid->worstTime)
+				pid->worstTime = pid->settleTime;
+		}
+
+		//run has timed out
+		else if(pid_isTimedOutRef(pid) && (pid->samples - 1) * pid->period < pid->timeout)
+			pid->timeouts++;
+	}
+
+	return pid->output;
+}
+
+/*
+ * Check if the current run has settled.
+ *
+ * @param pid The pid controller being accessed.
+ * @return If the current run has settled.
+ */
+bool pid_isSettled(PID pid){
+	return pid_isSettledRef(&pid);
+}
+
+/*
+ * Check if the current run has been going for longer than
+ * the timeout without settling.
+ *
+ * @param pid The pid controller being accessed.
+ * @return If the current run has timed out.
+ */
+bool pid_isTimedOut(PID pid){
+	return pid_isTimedOutRef(&pid);
+}
+
+/*
+ * Retrieve the target of the controller.
+ *
+ * @param pid The pid controller being accessed.
+ * @return The target of the controller.
+ */
+int pid_getTarget(PID pid){
+	return pid_getTargetRef(&pid);
+}
+
+/*
+ * Retrieve the last output of the controller.
+ *
+ * @param pid The pid controller being accessed.
+ * @return The last output of the controller.
+ */
+int pid_getOutput(PID pid){
+	return pid_getOutputRef(&pid);
+}
+
+/*
+ * Retrieve the sample period of the controller.
+ *
+ * @param pid The pid controller being accessed.
+ * @return The sample period in milliseconds.
+ */
+unsigned long pid_getPeriod(PID pid){
+	return pid_getPeriodRef(&pid);
+}
+
+/*
+ * Retrieve the time the last settled run took to settle.
+ *
+ * @param pid The pid controller being accessed.
+ * @return The settle time in milliseconds.
+ */
+unsigned long pid_getSettleTime(PID pid){
+	return pid_getSettleTimeRef(&pid);
+}
+
+/*
+ * Retrieve the average settle time of every settled run.
+ *
+ * @param pid The pid controller being accessed.
+ * @return The average settle time in milliseconds.
+ */
+unsigned long pid_getAverageSettleTime(PID pid){
+
+	//no runs have settled
+	if(pid.runs == 0)
+		return 0;
+
+	return pid.totalTime / pid.runs;
+}
+
+/*
+ * Retrieve the largest distance the system has gone past the
+ * target during the current run.
+ *
+ * @param pid The pid controller being accessed.
+ * @return The overshoot in sensor units.
+ */
+int pid_getOvershoot(PID pid){
+	return pid_getOvershootRef(&pid);
+}
+
+/*
+ * Clear the settle statistics of the controller.
+ *
+ * @param pid The pid controller being manipulated.
+ */
+void pid_clearStats(PID* pid){
+	pid->settleTime = 0;
+	pid->runs = 0;
+	pid->timeouts = 0;
+	pid->worstTime = 0;
+	pid->totalTime = 0;
+}
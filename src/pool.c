@@ -0,0 +1,177 @@
+/*
+ * @file pool.c
+ *
+ * @brief Implementation of the fixed capacity memory pools. Each pool
+ *		  hands out consecutive entries until it is reset, which returns
+ *		  every entry at once.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <pool.h>
+
+static Motor poolMotors[POOL_MOTORS];			//motor pool storage
+static int poolPorts[POOL_PORTS];					//sensor port pool storage
+static Sensor poolSensors[POOL_SENSORS];	//sensor pool storage
+static int poolWeights[POOL_WEIGHTS];			//sensor weight pool storage
+static LinearTable poolTables[POOL_TABLES];	//linearisation table pool storage
+
+static int poolUsed[POOL_COUNT];									//entries allocated from each pool
+static int poolPeak[POOL_COUNT];									//most entries ever allocated from each pool
+static unsigned int poolOverflows;			//allocations that did not fit
+static const int poolCapacity[POOL_COUNT] = {POOL_MOTORS, POOL_PORTS, POOL_SENSORS, POOL_WEIGHTS, POOL_TABLES};
+
+/*
+ * Reserve entries from a pool.
+ *
+ * @param pool The pool being allocated from.
+ * @param count The number of entries wanted, reduced to what fits.
+ * @return The index of the first entry reserved.
+ */
+static int pool_reserve(int pool, int* count){
+
+	int start = poolUsed[pool];	//first free entry
+
+	//negative request
+	if(*count < 0)
+		*count = 0;
+
+	//request does not fit
+	if(*count > poolCapacity[pool] - start){
+		*count = poolCapacity[pool] - start;
+		poolOverflows++;
+	}
+
+	poolUsed[pool] += *count;
+
+	//new high water mark
+	if(poolUsed[pool] > poolPeak[pool])
+		poolPeak[pool] = poolUsed[pool];
+
+	return start;
+}
+
+/*
+ * Allocate motors from the motor pool.
+ *
+ * @param count The number of motors wanted, reduced to what fits.
+ * @return The first motor allocated.
+ */
+Motor* pool_allocMotors(int* count){
+	return &poolMotors[pool_reserve(POOL_MOTOR, count)];
+}
+
+/*
+ * Allocate sensor ports from the port pool.
+ *
+ * @param count The number of ports wanted, reduced to what fits.
+ * @return The first port allocated.
+ */
+int* pool_allocPorts(int* count){
+	return &poolPorts[pool_reserve(POOL_PORT, count)];
+}
+
+/*
+ * Allocate sensors from the sensor pool.
+ *
+ * @param count The number of sensors wanted, reduced to what fits.
+ * @return The first sensor allocated.
+ */
+Sensor* pool_allocSensors(int* count){
+	return &poolSensors[pool_reserve(POOL_SENSOR, count)];
+}
+
+/*
+ * Allocate sensor weights from the weight pool.
+ *
+ * @param count The number of weights wanted, reduced to what fits.
+ * @return The first weight allocated.
+ */
+int* pool_allocWeights(int* count){
+	return &poolWeights[pool_reserve(POOL_WEIGHT, count)];
+}
+
+/*
+ * Allocate linearisation tables from the table pool.
+ *
+ * @param count The number of tables wanted, reduced to what fits.
+ * @return The first table allocated.
+ */
+LinearTable* pool_allocTables(int* count){
+	return &poolTables[pool_reserve(POOL_TABLE, count)];
+}
+
+/*
+ * Return every allocation to the pools. Anything still using pool
+ * memory must be initialized again after a reset.
+ */
+void pool_reset(){
+	for(int i = 0; i < POOL_COUNT; i++)
+		poolUsed[i] = 0;
+}
+
+/*
+ * Retrieve the number of entries allocated from a pool.
+ *
+ * @param pool The pool being accessed.
+ * @return The number of entries allocated.
+ */
+int pool_getUsed(int pool){
+	return pool >= 0 && pool < POOL_COUNT ? poolUsed[pool] : 0;
+}
+
+/*
+ * Retrieve the most entries ever allocated from a pool at once.
+ *
+ * @param pool The pool being accessed.
+ * @return The high water mark of the pool.
+ */
+int pool_getPeak(int pool){
+	return pool >= 0 && pool < POOL_COUNT ? poolPeak[pool] : 0;
+}
+
+/*
+ * Retrieve the number of entries in a pool.
+ *
+ * @param pool The pool being accessed.
+ * @return The capacity of the pool.
+ */
+int pool_getCapacity(int pool){
+	return pool >= 0 && pool < POOL_COUNT ? poolCapacity[pool] : 0;
+}
+
+/*
+ * Retrieve the number of allocations that did not fit in their pool
+ * and were shortened.
+ *
+ * @return The number of overflows.
+ */
+unsigned int pool_getOverflows(){
+	return poolOverflows;
+}
+
+/*
+ * Write the high water mark and capacity of every pool as a single
+ * telemetry line.
+ *
+ * @param stream The stream the line is written to.
+ */
+void pool_report(FILE* stream){
+	fprintf(stream, "POOL motors %d/%d ports %d/%d sensors %d/%d weights %d/%d tables %d/%d overflows %u\r\n",
+	        poolPeak[POOL_MOTOR], POOL_MOTORS, poolPeak[POOL_PORT], POOL_PORTS,
+	        poolPeak[POOL_SENSOR], POOL_SENSORS, poolPeak[POOL_WEIGHT], POOL_WEIGHTS,
+	        poolPeak[POOL_TABLE], POOL_TABLES, poolOverflows);
+}
@@ -0,0 +1,280 @@
+/*
+ * @file profile.c
+ *
+ * @brief Implementation of the motion profile generator. A trapezoidal
+ *		  profile is computed first. When a jerk limit is set the
+ *		  trapezoid is passed through a moving average whose length is
+ *		  the time it takes to reach full acceleration, which limits
+ *		  jerk and turns it into an S-curve without changing the
+ *		  distance travelled.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <profile.h>
+
+/*
+ * Retrieve the position of a trapezoidal profile at a sample.
+ *
+ * @param sample The sample number.
+ * @param d The distance being travelled.
+ * @param v The cruise velocity in units per sample.
+ * @param a The acceleration in units per sample squared.
+ * @param ta The number of samples spent accelerating.
+ * @param tc The number of samples spent cruising.
+ * @param total The total number of samples in the profile.
+ * @return The position at the sample.
+ */
+static Fixed profile_trapezoid(int sample, Fixed d, Fixed v, Fixed a, Fixed ta, Fixed tc, Fixed total){
+
+	Fixed t = fixed_fromInt(sample);	//time in samples
+
+	//before the profile starts
+	if(sample <= 0)
+		return 0;
+
+	//after the profile ends
+	else if(t >= total)
+		return d;
+
+	//accelerating
+	else if(t < ta)
+		return fixed_mul(fixed_mul(a, t), t) / 2;
+
+	//cruising
+	else if(t < ta + tc)
+		return fixed_mul(fixed_mul(a, ta), ta) / 2 + fixed_mul(v, t - ta);
+
+	//decelerating
+	Fixed r = total - t;	//samples remaining
+	return d - fixed_mul(fixed_mul(a, r), r) / 2;
+}
+
+/*
+ * Initialize the profile constraints. The setpoint table is empty
+ * until the profile is generated.
+ *
+ * @param maxVelocity The maximum velocity in units per second.
+ * @param maxAccel The maximum acceleration in units per second squared.
+ * @param maxJerk The maximum jerk in units per second cubed, zero for a trapezoidal profile.
+ * @param period The sample period in milliseconds.
+ * @return The profile being initialized.
+ */
+Profile profile_init(int maxVelocity, int maxAccel, int maxJerk, unsigned long period){
+	Profile tmp;											//profile being returned
+	tmp.maxVelocity = abs(maxVelocity);	//set velocity limit
+	tmp.maxAccel = abs(maxAccel);				//set acceleration limit
+	tmp.maxJerk = abs(maxJerk);					//set jerk limit
+	tmp.period = period > 0 ? period : 1;	//set sample period
+	tmp.kV = 0;													//no feedforward
+	tmp.start = 0;											//empty table
+	tmp.end = 0;
+	tmp.length = 0;
+	tmp.index = 0;
+
+	return tmp;
+}
+
+/*
+ * Set the velocity feedforward gain that is added to the controller
+ * output while following the profile.
+ *
+ * @param profile The profile being manipulated.
+ * @param kV The fixed-point gain in motor output per unit per second.
+ */
+void profile_setFeedforward(Profile* profile, Fixed kV){
+	profile->kV = kV;
+}
+
+/*
+ * Generate the setpoint table from the start position to the end
+ * position. If the table already holds the same move it is reused.
+ * Following restarts from the first setpoint.
+ *
+ * @param profile The profile being manipulated.
+ * @param start The position the move starts at.
+ * @param end The position the move ends at.
+ * @return If the move fits in the table.
+ */
+bool profile_generate(Profile* profile, int start, int end){
+
+	//table already holds this move
+	if(profile->length > 0 && profile->start == start && profile->end == end){
+		profile_restart(profile);
+		return true;
+	}
+
+	profile->start = start;	//set the start position
+	profile->end = end;			//set the end position
+	profile->length = 0;		//empty the table
+	profile->index = 0;			//start at the first setpoint
+
+	int period = profile->period;		//sample period
+	int sign = end < start ? -1 : 1;	//direction of the move
+
+	//invalid constraints
+	if(profile->maxVelocity == 0 || profile->maxAccel == 0)
+		return false;
+
+	//convert constraints from per second to per sample
+	Fixed d = fixed_fromInt(abs(end - start));
+	Fixed v = fixed_saturate(((int64_t)profile->maxVelocity * period << FIXED_SHIFT) / 1000);
+	Fixed a = fixed_saturate(((int64_t)profile->maxAccel * period * period << FIXED_SHIFT) / 1000000);
+
+	//acceleration is too small to represent
+	if(v == 0 || a == 0)
+		return false;
+
+	//samples needed to reach full acceleration at the jerk limit
+	int window = 1;
+	if(profile->maxJerk > 0)
+		window = ((int64_t)profile->maxAccel * 1000 + (int64_t)profile->maxJerk * period - 1) / ((int64_t)profile->maxJerk * period);
+	if(window < 1)
+		window = 1;
+
+	//move is too short to reach the maximum velocity
+	if(fixed_mul(d, a) < fixed_mul(v, v))
+		v = trig_sqrt(fixed_mul(d, a));
+
+	Fixed ta = v > 0 ? fixed_div(v, a) : 0;														//samples accelerating
+	Fixed tc = v > 0 ? fixed_div(d - fixed_mul(v, ta), v) : 0;				//samples cruising
+	Fixed total = 2 * ta + tc;																				//samples in the trapezoid
+	int length = ((total + FIXED_ONE - 1) >> FIXED_SHIFT) + window;		//setpoints including the first
+
+	//move does not fit in the table
+	if(length > PROFILE_SAMPLES)
+		return false;
+
+	Fixed last = 0;	//position of the previous setpoint
+
+	//average the trapezoid over the jerk window
+	for(int i = 0; i < length; i++){
+		int64_t sum = 0;
+		for(int j = 0; j < window; j++)
+			sum += profile_trapezoid(i - j, d, v, a, ta, tc, total);
+
+		Fixed position = sum / window;
+		profile->position[i] = sign * fixed_toInt(position);
+		profile->velocity[i] = sign * (int)((((int64_t)(position - last) * 1000 / period) + FIXED_HALF) >> FIXED_SHIFT);
+		last = position;
+	}
+
+	profile->length = length;
+	return true;
+}
+
+/*
+ * Start following the profile from the first setpoint.
+ *
+ * @param profile The profile being manipulated.
+ */
+void profile_restart(Profile* profile){
+	profile->index = 0;
+}
+
+/*
+ * Advance to the next setpoint. This should be called once every
+ * sample period while following the profile.
+ *
+ * @param profile The profile being manipulated.
+ */
+void profile_step(Profile* profile){
+	if(profile->index < profile->length)
+		profile->index++;
+}
+
+/*
+ * Check if every setpoint in the profile has been followed.
+ *
+ * @param profile The profile being accessed.
+ * @return If the profile is done.
+ */
+bool profile_isDone(Profile* profile){
+	return profile->index >= profile->length;
+}
+
+/*
+ * Retrieve the position the profile starts at.
+ *
+ * @param profile The profile being accessed.
+ * @return The start position.
+ */
+int profile_getStart(Profile* profile){
+	return profile->start;
+}
+
+/*
+ * Retrieve the position the profile ends at.
+ *
+ * @param profile The profile being accessed.
+ * @return The end position.
+ */
+int profile_getEnd(Profile* profile){
+	return profile->end;
+}
+
+/*
+ * Retrieve the number of setpoints in the profile.
+ *
+ * @param profile The profile being accessed.
+ * @return The number of setpoints.
+ */
+int profile_getLength(Profile* profile){
+	return profile->length;
+}
+
+/*
+ * Retrieve the current position setpoint. Once the profile is done
+ * this is the end position.
+ *
+ * @param profile The profile being accessed.
+ * @return The current position setpoint.
+ */
+int profile_getSetpoint(Profile* profile){
+
+	//profile is done
+	if(profile_isDone(profile))
+		return profile->end;
+
+	return profile->start + profile->position[profile->index];
+}
+
+/*
+ * Retrieve the current velocity setpoint. Once the profile is done
+ * this is zero.
+ *
+ * @param profile The profile being accessed.
+ * @return The current velocity setpoint in units per second.
+ */
+int profile_getVelocity(Profile* profile){
+
+	//profile is done
+	if(profile_isDone(profile))
+		return 0;
+
+	return profile->velocity[profile->index];
+}
+
+/*
+ * Retrieve the feedforward motor output for the current velocity
+ * setpoint.
+ *
+ * @param profile The profile being accessed.
+ * @return The feedforward motor output.
+ */
+int profile_getFeedforward(Profile* profile){
+	return fixed_toInt(fixed_mulInt(profile->kV, profile_getVelocity(profile)));
+}
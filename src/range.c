@@ -0,0 +1,205 @@
+/*
+ * @file range.c
+ *
+ * @brief Implementation of the ultrasonic range history. Range finders
+ *		  are looked up by their echo port. The range finder is pinged in
+ *		  the background, so reading it faster than it pings returns the
+ *		  same echo. A repeated reading is only counted as new once
+ *		  RANGE_PERIOD has passed.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <range.h>
+
+static Range range[12];	//range history of digital ports one through twelve
+
+/*
+ * Retrieve the range history of an echo port.
+ *
+ * @param port The echo port.
+ * @return The range history, or NULL for an invalid port.
+ */
+static Range* range_get(int port){
+
+	//invalid port
+	if(port < 1 || port > 12)
+		return NULL;
+
+	return &range[port - 1];
+}
+
+/*
+ * Find the median of the valid readings.
+ *
+ * @param history The range history.
+ * @return The median range in cm.
+ */
+static int range_median(Range* history){
+
+	int sorted[RANGE_HISTORY];	//readings in ascending order
+
+	//insertion sort, starting from the newest reading
+	for(int i = 0; i < history->size; i++){
+		int value = history->values[(history->index - i + RANGE_HISTORY) % RANGE_HISTORY];	//reading being sorted
+		int j = i;
+		for(; j > 0 && sorted[j - 1] > value; j--)
+			sorted[j] = sorted[j - 1];
+		sorted[j] = value;
+	}
+
+	return sorted[history->size / 2];
+}
+
+/*
+ * Forget the history of a range finder.
+ *
+ * @param port The echo port.
+ */
+void range_reset(int port){
+
+	Range* history = range_get(port);	//range history of the port
+
+	//invalid port
+	if(history == NULL)
+		return;
+
+	history->index = 0;
+	history->size = 0;
+	history->stamp = 0;
+	history->raw = -1;
+	history->rawStamp = 0;
+	history->pendingCount = 0;
+}
+
+/*
+ * Check a new reading against the history and keep it if it is valid.
+ *
+ * @param port The echo port.
+ * @param reading The reading in cm.
+ * @return The latest valid range in cm, 0 if there has not been one.
+ */
+int range_update(int port, int reading){
+
+	Range* history = range_get(port);	//range history of the port
+
+	//invalid port
+	if(history == NULL)
+		return reading;
+
+	unsigned long now = millis();	//time of the reading
+
+	//same echo as last time
+	if(reading == history->raw && now - history->rawStamp < RANGE_PERIOD)
+		return range_getLatest(port);
+
+	history->raw = reading;
+	history->rawStamp = now;
+
+	//out of the sensor's range
+	if(reading < RANGE_MIN || reading > RANGE_MAX){
+		history->rejected++;
+		return range_getLatest(port);
+	}
+
+	//reading jumped away from the recent readings
+	if(history->size > 0 && abs(reading - range_median(history)) > RANGE_JUMP){
+
+		//count agreeing outliers
+		if(history->pendingCount > 0 && abs(reading - history->pending) <= RANGE_JUMP)
+			history->pendingCount++;
+		else{
+			history->pending = reading;
+			history->pendingCount = 1;
+		}
+
+		//outlier is not confirmed yet
+		if(history->pendingCount < RANGE_CONFIRM){
+			history->rejected++;
+			return range_getLatest(port);
+		}
+
+		history->size = 0;	//the range really changed, start the history over
+	}
+
+	//keep the reading
+	history->index = (history->index + 1) % RANGE_HISTORY;
+	history->values[history->index] = reading;
+	if(history->size < RANGE_HISTORY)
+		history->size++;
+	history->stamp = now;
+	history->pendingCount = 0;
+
+	return reading;
+}
+
+/*
+ * Retrieve the latest valid range.
+ *
+ * @param port The echo port.
+ * @return The range in cm, 0 if there has not been a valid reading.
+ */
+int range_getLatest(int port){
+
+	Range* history = range_get(port);	//range history of the port
+
+	//invalid port or no valid reading
+	if(history == NULL || history->size == 0)
+		return 0;
+
+	return history->values[history->index];
+}
+
+/*
+ * Retrieve the age of the latest valid range.
+ *
+ * @param port The echo port.
+ * @return The age in ms, RANGE_NEVER if there has not been a valid reading.
+ */
+unsigned long range_getAge(int port){
+
+	Range* history = range_get(port);	//range history of the port
+
+	//invalid port or no valid reading
+	if(history == NULL || history->size == 0)
+		return RANGE_NEVER;
+
+	return millis() - history->stamp;
+}
+
+/*
+ * Check if a range finder has had a valid reading.
+ *
+ * @param port The echo port.
+ * @return If there is a valid range.
+ */
+bool range_isValid(int port){
+	return range_getLatest(port) != 0;
+}
+
+/*
+ * Retrieve the number of readings rejected as out of range or as
+ * outliers.
+ *
+ * @param port The echo port.
+ * @return The number of rejected readings.
+ */
+unsigned int range_getRejected(int port){
+
+	Range* history = range_get(port);	//range history of the port
+
+	return history != NULL ? history->rejected : 0;
+}
@@ -23,12 +23,28 @@
 
 #include <robot.h>
 #include <main.h>
+#include <pool.h>
+#include <sampler.h>
+#include <odometry.h>
+#include <health.h>
+#include <impact.h>
 
 /*
  * Initialize the robot.
  */
 void robot_init(){
-	Robot.liftConst = 0.7;		//set default value for PID lift constant
+	linear_init();	//build the motor linearisation tables
+
+	Robot.liftPID = pid_init(FIXED(0.7), 0, 0);		//set default value for PID lift constant
+	Robot.intakePID = pid_init(FIXED(0.7), 0, 0);	//set default value for PID intake constant
+
+	//lift motion profile
+	Robot.liftProfile = profile_init(LIFT_VELOCITY, LIFT_ACCEL, LIFT_JERK, pid_getPeriodRef(&Robot.liftPID));
+	profile_setFeedforward(&Robot.liftProfile, LIFT_FEEDFORWARD);
+	profile_generate(&Robot.liftProfile, LIFT_MIN, LIFT_SCORE);	//precompute the most common move
+
+	sampler_start(SAMPLER_PERIOD);	//sample sensors once per tick
+	thermal_start(THERMAL_PERIOD);	//integrate the motor thermal model
 }
 
 /*
@@ -74,7 +90,7 @@ int robot_getIntakePos(){
  * @return Robot's PID lift constant value.
  */
 double robot_getLiftConst(){
-	return Robot.liftConst;
+	return fixed_toDouble(robot_getLiftConstFixed());
 }
 
 /*
@@ -83,7 +99,27 @@ double robot_getLiftConst(){
  * @return Robot's PID intake constant value.
  */
 double robot_getIntakeConst(){
-	return Robot.intakeConst;
+	return fixed_toDouble(robot_getIntakeConstFixed());
+}
+
+/*
+ * Retrieve the robot's PID lift constant value without
+ * converting it from fixed-point.
+ *
+ * @return Robot's fixed-point PID lift constant value.
+ */
+Fixed robot_getLiftConstFixed(){
+	return Robot.liftPID.kP;
+}
+
+/*
+ * Retrieve the robot's PID intake constant value without
+ * converting it from fixed-point.
+ *
+ * @return Robot's fixed-point PID intake constant value.
+ */
+Fixed robot_getIntakeConstFixed(){
+	return Robot.intakePID.kP;
 }
 
 /*
@@ -106,13 +142,13 @@ void robot_lcdMenu(){
 	while(powerLevelMain() <= 6000){
 		lcd_centerPrint(&Robot.lcd, TOP, "WARNING!!!");						//print lcd warning
 		lcd_centerPrint(&Robot.lcd, BOTTOM, "Battery Critical");	//print lcd warning
-		lcd_backLight(&Robot.lcd, !lcd_backLightIsOn(Robot.lcd));	//toggle the robot's lcd backlight
+		lcd_backLight(&Robot.lcd, !lcd_backLightIsOnRef(&Robot.lcd));	//toggle the robot's lcd backlight
 		delay(250);																								//delay to make strobe visible
 	}
 
 	lcd_backLight(&Robot.lcd, ON);	//turn on the robot's lcd backlight
 	lcd_clear(&Robot.lcd);					//clear lcd
-	lcd_waitForRelease(Robot.lcd);	//wait for the button to be released before proceeding
+	lcd_waitForReleaseRef(&Robot.lcd);	//wait for the button to be released before proceeding
 
 	Robot.mode = SENSORS;															//set the default mode to SENSORS
 
@@ -122,17 +158,15 @@ void robot_lcdMenu(){
 		lcd_centerPrint(&Robot.lcd, TOP, "Select Mode");	//print lcd prompt
 
 		//display modes and allow user to select robot mode
-		for(int i = 0; !lcd_buttonIsPressed(Robot.lcd, LCD_BTN_CENTER); i = i){
+		for(int i = 0, btn = 0; btn != LCD_BTN_CENTER; i = i){
+
+			btn = lcd_getPress(&Robot.lcd);	//take the next press
 
 			//Cycle through modes
-			if(lcd_buttonIsPressed(Robot.lcd, LCD_BTN_LEFT)){
+			if(btn == LCD_BTN_LEFT)
 				i--;
-				lcd_waitForRelease(Robot.lcd);
-			}
-			else if(lcd_buttonIsPressed(Robot.lcd, LCD_BTN_RIGHT)){
+			else if(btn == LCD_BTN_RIGHT)
 				i++;
-				lcd_waitForRelease(Robot.lcd);
-			}
 
 			//allow selection to wrap around
 			if(i > SENSORS)
@@ -140,8 +174,7 @@ void robot_lcdMenu(){
 			else if(i < COMPETITION)
 				i = SENSORS;
 
-			Robot.mode = i;											//set the current mode for the robot
-			lcd_clearLine(&Robot.lcd, BOTTOM);	//clear the bottom LCD line
+			Robot.mode = i;	//set the current mode for the robot
 
 			//display the current mode choice
 			switch(i){
@@ -161,72 +194,72 @@ void robot_lcdMenu(){
 			delay(10);	//small delay to allow LCD to be readable
 		}
 
-		lcd_waitForRelease(Robot.lcd);	//wait for the button to be released before proceeding
+		lcd_waitForReleaseRef(&Robot.lcd);	//wait for the button to be released before proceeding
 		lcd_clear(&Robot.lcd);					//clear the lcd screen
 
 		//cycle through sensors
-		for(int i = 0; robot_getMode() == SENSORS && !lcd_buttonIsPressed(Robot.lcd, LCD_BTN_CENTER); i = i){
+		for(int i = 0, btn = 0; robot_getMode() == SENSORS && btn != LCD_BTN_CENTER; i = i){
 
 			lcd_centerPrint(&Robot.lcd, BOTTOM, "<     MENU     >");	//print lcd prompt
 
+			btn = lcd_getPress(&Robot.lcd);	//take the next press
+
 			//Cycle through modes
-			if(lcd_buttonIsPressed(Robot.lcd, LCD_BTN_LEFT)){
+			if(btn == LCD_BTN_LEFT)
 				i--;
-				lcd_waitForRelease(Robot.lcd);
-			}
-			else if(lcd_buttonIsPressed(Robot.lcd, LCD_BTN_RIGHT)){
+			else if(btn == LCD_BTN_RIGHT)
 				i++;
-				lcd_waitForRelease(Robot.lcd);
-			}
 
 			//allow selection to wrap around
-			if(i > TURN)
-				i = INTAKE;
+			if(i > MOTOR_TEMP)
+				i = LIFT;
 			else if(i < LIFT)
-				i = INTAKE;
+				i = MOTOR_TEMP;
 
-			lcd_clearLine(&Robot.lcd, TOP);	//clear the LCD
+			char text[LCD_WIDTH + 1] = "";	//sensor reading being displayed
 
 			//display the current mode choice
 			switch(i){
 				case LIFT:
-					lcdPrint(Robot.lcd.port, TOP, "Lift: %d", sensor_getValue(Robot.liftSensor));
+					snprintf(text, sizeof(text), "Lift: %d", sensor_getValueRef(&Robot.liftSensor));
 				break;
 				case RIGHT_DRIVE:
-					lcdPrint(Robot.lcd.port, TOP, "R. Drive: %d", sensor_getValue(Robot.rightDriveSensor));
+					snprintf(text, sizeof(text), "R. Drive: %d", sensor_getValueRef(&Robot.rightDriveSensor));
 				break;
 				case LEFT_DRIVE:
-					lcdPrint(Robot.lcd.port, TOP, "L. Drive: %d", sensor_getValue(Robot.leftDriveSensor));
+					snprintf(text, sizeof(text), "L. Drive: %d", sensor_getValueRef(&Robot.leftDriveSensor));
 				break;
 				case TURN:
-					lcdPrint(Robot.lcd.port, TOP, "Turn: %d", sensor_getValue(Robot.turnSensor));
+					snprintf(text, sizeof(text), "Turn: %d", sensor_getValueRef(&Robot.turnSensor));
 				break;
 				case INTAKE:
-					lcdPrint(Robot.lcd.port, TOP, "Intake: %d", sensor_getValue(Robot.intakeSensor));
+					snprintf(text, sizeof(text), "Intake: %d", sensor_getValueRef(&Robot.intakeSensor));
+				break;
+				case MOTOR_TEMP:
+					snprintf(text, sizeof(text), "Hot: P%d %dC", thermal_getHottest(), thermal_getTemperature(thermal_getHottest()));
 				break;
 			}
+			lcd_print(&Robot.lcd, TOP, text);
 			delay(10);	//small delay to allow LCD to be readable
 		}
-		lcd_waitForRelease(Robot.lcd);	//wait for the button to be released before proceeding
+		lcd_waitForReleaseRef(&Robot.lcd);	//wait for the button to be released before proceeding
 		lcd_clear(&Robot.lcd);					//clear the lcd screen
 	}
 
-	lcd_waitForRelease(Robot.lcd);										//wait for the button to be released before proceeding
+	lcd_waitForReleaseRef(&Robot.lcd);										//wait for the button to be released before proceeding
 	lcd_clear(&Robot.lcd);														//clear the lcd screen
   lcd_centerPrint(&Robot.lcd, TOP, "Select Auton");	//print lcd prompt
 
 	//select the autonomous
-	for(int i = 1; !lcd_buttonIsPressed(Robot.lcd, LCD_BTN_CENTER); i = i){
+	for(int i = 1, btn = 0; btn != LCD_BTN_CENTER; i = i){
+
+		btn = lcd_getPress(&Robot.lcd);	//take the next press
 
 		//Cycle through modes
-		if(lcd_buttonIsPressed(Robot.lcd, LCD_BTN_LEFT)){
+		if(btn == LCD_BTN_LEFT)
 			i--;
-			lcd_waitForRelease(Robot.lcd);
-		}
-		else if(lcd_buttonIsPressed(Robot.lcd, LCD_BTN_RIGHT)){
+		else if(btn == LCD_BTN_RIGHT)
 			i++;
-			lcd_waitForRelease(Robot.lcd);
-		}
 
 		//allow selection to wrap around
 		if(i > AUTON4)
@@ -234,8 +267,7 @@ void robot_lcdMenu(){
 		else if(i < SKILLS)
 			i = AUTON4;
 
-		Robot.auton = i;										//set the current mode for the robot
-		lcd_clearLine(&Robot.lcd, BOTTOM);	//clear the bottom LCD line
+		Robot.auton = i;	//set the current mode for the robot
 
 		//display the current mode choice
 		switch(i){
@@ -257,7 +289,7 @@ void robot_lcdMenu(){
 		}
 		delay(10);	//small delay to allow LCD to be readable
 	}
-	lcd_waitForRelease(Robot.lcd);	//wait for the button to be released before proceeding
+	lcd_waitForReleaseRef(&Robot.lcd);	//wait for the button to be released before proceeding
 	lcd_clear(&Robot.lcd);					//clear the lcd screen
 }
 
@@ -334,36 +366,252 @@ void robot_setDriveForSplit(char left, char right, unsigned int time){
 }
 
 /*
- * Have the robot's lift go to the desired position
+ * Start tracking the robot's pose from the drive sensors and the turn
+ * sensor. The drive and turn sensors should be initialized first. The
+ * heading comes from the drive sensors alone if the turn sensor was
+ * never initialized, and nothing is tracked if a drive sensor was not.
+ */
+void robot_startOdometry(){
+
+	//drive sensors have not been set up
+	if(Robot.leftDriveSensor.ports == NULL || Robot.rightDriveSensor.ports == NULL)
+		return;
+
+	odometry_init(&Robot.leftDriveSensor, &Robot.rightDriveSensor, Robot.turnSensor.ports != NULL ? &Robot.turnSensor : NULL, DRIVE_TRACK);
+	odometry_start(ODOMETRY_PERIOD);
+}
+
+/*
+ * Start detecting collisions and tipping with the accelerometer. The
+ * accelerometer axes should be initialized first, and the robot must be
+ * still and level while the accelerometer is calibrated. Nothing is
+ * detected if none of the axes have been initialized.
+ */
+void robot_startImpact(){
+	impact_init(&Robot.accelX, &Robot.accelY, &Robot.accelZ, IMPACT_SCALE);
+	impact_calibrate();
+	impact_start(IMPACT_PERIOD);
+}
+
+/*
+ * Feed the measured speed of a drive side to the thermal model of each
+ * of its motors. Nothing is fed if the drive sensor was never set up.
+ *
+ * @param drive The drive motor system.
+ * @param sensor The drive sensor measuring the motor system.
+ */
+static void robot_feedSpeed(const MotorSystem* drive, const Sensor* sensor){
+
+	//drive sensor has not been set up
+	if(sensor->ports == NULL)
+		return;
+
+	int speed = sensor_getVelocityRef(sensor) * 127 / DRIVE_FULL_SPEED;	//speed in command units
+
+	//feed each motor, the model works on port commands
+	for(int i = 0; i < drive->size; i++)
+		thermal_setSpeed(drive->motors[i].port, drive->motors[i].reversed ? -speed : speed);
+}
+
+/*
+ * Monitor task. Feeds the drive speed to the thermal model every
+ * period, writes the motor temperatures every report period and writes
+ * the sensor fault counters whenever a new fault is counted.
+ *
+ * @param ignore Unused task parameter.
+ */
+static void robot_monitor(void* ignore){
+
+	unsigned long wake = millis();		//time of the last check
+	unsigned long reported = wake;		//time of the last report
+	unsigned int faults = 0;					//sensor faults at the last health report
+
+	//monitor forever
+	while(true){
+		robot_feedSpeed(&Robot.leftDrive, &Robot.leftDriveSensor);
+		robot_feedSpeed(&Robot.rightDrive, &Robot.rightDriveSensor);
+
+		//report the motor temperatures
+		if(millis() - reported >= MONITOR_REPORT){
+			thermal_report(stdout);
+			reported = millis();
+		}
+
+		//report the sensor faults when one is counted
+		if(health_getTotalFaults() != faults){
+			faults = health_getTotalFaults();
+			health_report(stdout);
+		}
+
+		taskDelayUntil(&wake, MONITOR_PERIOD);
+	}
+}
+
+/*
+ * Start feeding the measured drive speed to the motor thermal model and
+ * reporting the motor temperatures and sensor faults. The drive motors and sensors should
+ * be initialized first. Does nothing if the monitor is already running.
+ */
+void robot_startMonitor(){
+
+	static TaskHandle monitor = NULL;	//monitor task
+
+	//start the task once
+	if(monitor == NULL)
+		monitor = taskCreate(robot_monitor, TASK_DEFAULT_STACK_SIZE, NULL, TASK_PRIORITY_DEFAULT);
+}
+
+/*
+ * Drive forward onto a line and square up on it. Each side of the drive
+ * stops as soon as the outer line sensor on that side reaches the line,
+ * so the robot ends square to the line. The line sensor array must be
+ * built with line_init from at least two sensors, and is sampled by the
+ * line task from here on. This is a library routine for autonomous code
+ * written against a line array; the recorded autonomous does not call it.
+ *
+ * @param velocity The velocity of the drive.
+ * @param timeout The longest time in ms to drive for.
+ * @return If both sides reached the line before the timeout.
+ */
+bool robot_squareUp(char velocity, unsigned long timeout){
+
+	//array can not tell the sides apart
+	if(Robot.line.size < 2)
+		return false;
+
+	unsigned long start = millis();	//time the drive started
+	bool left = false;							//flag for the left side being on the line
+	bool right = false;							//flag for the right side being on the line
+	LineEvent event;								//event being handled
+
+	line_start(&Robot.line, LINE_PERIOD);	//sample the line sensors quickly
+	line_flush(&Robot.line);							//forget lines crossed before the move
+	robot_setDrive(velocity);
+
+	//drive until both sides reach the line
+	while(!(left && right) && millis() - start < timeout){
+
+		//check each sensor that has reached the line
+		while(line_pop(&Robot.line, &event)){
+			if(event.on && event.sensor == 0)
+				left = true;
+			else if(event.on && event.sensor == Robot.line.size - 1)
+				right = true;
+		}
+
+		//stop the sides that are on the line
+		if(left)
+			motorSystem_stop(&Robot.leftDrive);
+		if(right)
+			motorSystem_stop(&Robot.rightDrive);
+
+		delay(LINE_PERIOD);
+	}
+
+	robot_stop();	//stop the drive
+	return left && right;
+}
+
+/*
+ * Generate the lift motion profile for a move to the desired
+ * position. The move starts from the last target if the lift is
+ * still there, so moves between preset positions reuse the table.
+ *
+ * @param pos The desired lift position.
+ * @param start The current lift position.
+ * @return If the move fits in the profile.
+ */
+static bool robot_liftProfile(int pos, int start){
+
+	//lift is still at the last target
+	if(abs(start - robot_getLiftPos()) <= Robot.liftPID.settleError)
+		start = robot_getLiftPos();
+
+	Robot.liftPos = pos;	//set the new target lift position
+	return profile_generate(&Robot.liftProfile, start, pos);
+}
+
+/*
+ * Have the robot's lift go to the desired position along the lift
+ * motion profile. During the operator control period this runs a
+ * single sample of the lift controller and should be called once
+ * every sample period. The robot is treated as tipping at a smaller
+ * tilt while the lift is high, and a raised lift is brought down if
+ * the robot tips.
  *
  * @param pos The desired lift position.
  */
  void robot_liftToPosition(int pos){
 
+ 	//robot is tipping with the lift raised, lower it
+ 	if(impact_isTipping() && pos > LIFT_SCORE)
+ 		pos = LIFT_MIN;
+
+ 	impact_setTipLimit(pos > LIFT_SCORE ? LIFT_TIP : IMPACT_TIP);	//a raised lift makes the robot top heavy
+
  	//it is the autonomous period
- 	if(isAutonomous())
- 		motorSystem_setTillPID(&Robot.lift, &Robot.liftSensor, robot_getLiftConst(), pos);
+ 	if(isAutonomous()){
+
+ 		//follow the profile, or go straight to the target if the move does not fit
+ 		if(robot_liftProfile(pos, sensor_getValueRef(&Robot.liftSensor)))
+ 			motorSystem_followProfile(&Robot.lift, &Robot.liftSensor, &Robot.liftPID, &Robot.liftProfile);
+ 		else
+ 			motorSystem_setTillPID(&Robot.lift, &Robot.liftSensor, &Robot.liftPID, pos);
+ 	}
 
  	//it is op control period
  	else{
- 		//update motor in PID loop until sensor target value is near
- 		if(sensor_getValue(Robot.liftSensor) != pos || (pos - sensor_getValue(Robot.liftSensor)) * robot_getLiftConst() < 10)
- 			motorSystem_setVelocity(&Robot.lift, (pos - sensor_getValue(Robot.liftSensor)) * robot_getLiftConst());
 
- 		//target position has been reached
+ 		int value = sensor_getValueRef(&Robot.liftSensor);	//lift position for this sample
+
+ 		//new target position
+ 		if(pos != robot_getLiftPos()){
+ 			robot_liftProfile(pos, value);				//generate the move
+ 			pid_reset(&Robot.liftPID);						//start a new run
+ 			health_rearm(Robot.liftSensor.id);	//give the lift sensor a new chance to move
+ 		}
+
+ 		int setpoint = pos;	//position the lift is following
+ 		int feedforward = 0;	//feedforward output for the setpoint
+
+ 		//profile holds this move
+ 		if(profile_getEnd(&Robot.liftProfile) == pos){
+ 			setpoint = profile_getSetpoint(&Robot.liftProfile);
+ 			feedforward = profile_getFeedforward(&Robot.liftProfile);
+ 			profile_step(&Robot.liftProfile);
+ 		}
+
+ 		pid_moveTarget(&Robot.liftPID, setpoint);										//follow the setpoint
+ 		int output = pid_update(&Robot.liftPID, value) + feedforward;	//output that holds the lift at the setpoint
+
+ 		//lift sensor has failed, let the lift rest rather than drive it into a hard stop
+ 		if(!health_watch(Robot.liftSensor.id, value, output))
+ 			motorSystem_stop(&Robot.lift);
  		else
- 			motorSystem_stop(&Robot.lift);	//stop motor
+ 			motorSystem_setVelocity(&Robot.lift, output);
  	}
 }
 
 /**
  * Set the PID lift constant value for the
- * desired lift behavior.
+ * desired lift behavior. The value is converted to
+ * fixed-point once here, so the control loop stays
+ * integer only.
  *
  * @param val The new value for the lift constant.
  */
 void robot_setLiftConst(double val){
-	Robot.liftConst = val;
+	robot_setLiftConstFixed(fixed_fromDouble(val));
+}
+
+/**
+ * Set the PID lift constant value for the
+ * desired lift behavior from a fixed-point value.
+ *
+ * @param val The new fixed-point value for the lift constant.
+ */
+void robot_setLiftConstFixed(Fixed val){
+	Robot.liftPID.kP = val;
 }
 
 /*
@@ -388,54 +636,85 @@ void robot_intakeStop(){
 }
 
 /*
- * Have the robot's lift go to the desired position
+ * Have the robot's intake go to the desired position. During the
+ * operator control period this runs a single sample of the intake
+ * controller and should be called once every sample period.
  *
- * @param pos The desired lift position.
+ * @param pos The desired intake position.
  */
  void robot_positionIntake(int pos){
 
  	//it is the autonomous period
  	if(isAutonomous())
- 		motorSystem_setTillPID(&Robot.intake, &Robot.intakeSensor, robot_getIntakeConst(), pos);
+ 		motorSystem_setTillPID(&Robot.intake, &Robot.intakeSensor, &Robot.intakePID, pos);
 
  	//it is op control period
  	else{
- 		//update motor in PID loop until sensor target value is near
- 		if(sensor_getValue(Robot.intakeSensor) != pos || (pos - sensor_getValue(Robot.intakeSensor)) * robot_getIntakeConst() < 10)
- 			motorSystem_setVelocity(&Robot.intake, (pos - sensor_getValue(Robot.intakeSensor)) * robot_getIntakeConst());
 
- 		//target position has been reached
+ 		//new target position
+ 		if(pos != pid_getTargetRef(&Robot.intakePID))
+ 			health_rearm(Robot.intakeSensor.id);	//give the intake sensor a new chance to move
+
+ 		pid_setTarget(&Robot.intakePID, pos);																//start a new run if the target moved
+ 		int value = sensor_getValueRef(&Robot.intakeSensor);								//intake position for this sample
+ 		int output = pid_update(&Robot.intakePID, value);										//output that holds the intake at the target
+
+ 		//intake sensor has failed, let the intake rest rather than drive it blind
+ 		if(!health_watch(Robot.intakeSensor.id, value, output))
+ 			motorSystem_stop(&Robot.intake);
  		else
- 			motorSystem_stop(&Robot.intake);	//stop motor
+ 			motorSystem_setVelocity(&Robot.intake, output);
  	}
 }
 
 /**
  * Set the PID intake constant value for the
- * desired intake behavior.
+ * desired intake behavior. The value is converted to
+ * fixed-point once here, so the control loop stays
+ * integer only.
  *
- * @param val The new value for the lift constant.
+ * @param val The new value for the intake constant.
  */
 void robot_setIntakeConst(double val){
-	Robot.intakeConst = val;
+	robot_setIntakeConstFixed(fixed_fromDouble(val));
+}
+
+/**
+ * Set the PID intake constant value for the
+ * desired intake behavior from a fixed-point value.
+ *
+ * @param val The new fixed-point value for the intake constant.
+ */
+void robot_setIntakeConstFixed(Fixed val){
+	Robot.intakePID.kP = val;
 }
 
 /*
  * Free all sensors, sensor systems and motor systems that are associated
- * with the robot.
+ * with the robot by returning every allocation to the memory pools.
  */
 void robot_free(){
 
-	//free motor systems
+	odometry_stop();	//stop reading the drive sensors
+	impact_stop();		//stop reading the accelerometer
+	line_stop();			//stop reading the line sensors
+	sampler_clear();	//stop sampling the sensors before they are freed
+
+	//empty motor systems
 	motorSystem_free(&Robot.rightDrive);	//free the right drive
 	motorSystem_free(&Robot.leftDrive);		//free the left drive
 	motorSystem_free(&Robot.intake);			//free the intake
 	motorSystem_free(&Robot.lift);				//free the lift
 
-	//free sensors
+	//empty sensors
 	sensor_free(&Robot.rightDriveSensor);	//free the right drive sensor
 	sensor_free(&Robot.leftDriveSensor);	//free the left drive sensor
 	sensor_free(&Robot.liftSensor);				//free the lift sensor
 	sensor_free(&Robot.intakeSensor);			//free the intake sensor
 	sensor_free(&Robot.turnSensor);				//free the turn sensor
+	sensor_free(&Robot.accelX);						//free the accelerometer x axis
+	sensor_free(&Robot.accelY);						//free the accelerometer y axis
+	sensor_free(&Robot.accelZ);						//free the accelerometer z axis
+
+	pool_reset();	//return the memmory to the pools
 }
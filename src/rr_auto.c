@@ -22,6 +22,9 @@
 
 #include <rr_auto.h>
 #include <main.h>
+#include <impact.h>
+#include <dio.h>
+#include <sampler.h>
 
 /*
  * Record the robots movements for a set amount of time.
@@ -35,12 +38,13 @@
 void robot_record(const char* name, unsigned long int time){
 
 	FILE* file = fopen(name, "w");	//initialize file pointer
+	char text[LCD_WIDTH + 1];				//time being displayed
 
 	//count-down timer
 	lcd_centerPrint(&Robot.lcd, TOP, "Recording in:");
 	for(int i = 10; i > 0; i--){
-		lcd_clearLine(&Robot.lcd, BOTTOM);
-		lcdPrint(Robot.lcd.port, BOTTOM, "%d seconds", i);
+		snprintf(text, sizeof(text), "%d seconds", i);
+		lcd_print(&Robot.lcd, BOTTOM, text);
 		delay(1000);
 	}
 
@@ -53,14 +57,18 @@ void robot_record(const char* name, unsigned long int time){
 			userControl();	//do normal drive functions
 
 			//print time remaining onto the LCD
-			lcd_clearLine(&Robot.lcd, BOTTOM);
-			lcdPrint(Robot.lcd.port, BOTTOM, "T -%0.2f seconds", ((double)(time-counter)/1000));
+			snprintf(text, sizeof(text), "T -%0.2f seconds", ((double)(time-counter)/1000));
+			lcd_print(&Robot.lcd, BOTTOM, text);
 
 			//write motor values
 			for(int i = PORT_1; i <= PORT_10; i++)
 				writeMotorValue(file, i);
 
-			//write sensor values
+			//sample the digital pins once, unless the sampler already does every tick
+			if(!sampler_isRunning())
+				dio_sample();
+
+			//write sensor values from the digital I/O words, without reading the pins again
 			for(int i = DGTL_1; i <= DGTL_12; i++)
 				writeDigitalPortValue(file, i);
 
@@ -74,9 +82,52 @@ void robot_record(const char* name, unsigned long int time){
 	delay(1000);										//delay to read LCD message
 }
 
+/*
+ * Retrieve the direction the recorded commands drive
+ * the robot in, taking reversed drive motors into
+ * account.
+ *
+ * @param commands The recorded command of each motor port.
+ * @return 1 for forward, -1 for backward and 0 for a turn or a stop.
+ */
+static int replay_getDirection(const int* commands){
+
+	int sum = 0;	//forward command of the whole drive
+
+	//add up each side of the drive
+	for(int i = 0; i < Robot.leftDrive.size; i++)
+		sum += Robot.leftDrive.motors[i].reversed ? -commands[Robot.leftDrive.motors[i].port] : commands[Robot.leftDrive.motors[i].port];
+	for(int i = 0; i < Robot.rightDrive.size; i++)
+		sum += Robot.rightDrive.motors[i].reversed ? -commands[Robot.rightDrive.motors[i].port] : commands[Robot.rightDrive.motors[i].port];
+
+	return sum > 0 ? 1 : sum < 0 ? -1 : 0;
+}
+
+/*
+ * Check if a motor port drives the robot.
+ *
+ * @param port The motor port.
+ * @return If the port is in the left or right drive.
+ */
+static bool replay_isDrive(int port){
+
+	//search each side of the drive
+	for(int i = 0; i < Robot.leftDrive.size; i++)
+		if(Robot.leftDrive.motors[i].port == port)
+			return true;
+	for(int i = 0; i < Robot.rightDrive.size; i++)
+		if(Robot.rightDrive.motors[i].port == port)
+			return true;
+
+	return false;
+}
+
 /*
  * Replay the robots movements for a certain
- * alliance and position.
+ * alliance and position. The drive is held stopped
+ * when the robot hits something, until IMPACT_HOLDOFF
+ * has passed or the recording reverses away from the
+ * hit, and the replay ends if the robot tips.
  *
  * @param name The name of the file being played back.
  * 		       The file name is truncated to eight
@@ -85,22 +136,68 @@ void robot_record(const char* name, unsigned long int time){
 void robot_replay(const char* name){
 
 	FILE* file = fopen(name, "r");	//initialize file pointer
+	int commands[PORT_10 + 1];				//recorded command of each motor port
+	bool blocked = false;						//flag for the drive being held after a hit
+	unsigned long hit = 0;					//time of the last hit in milliseconds
+	int direction = 0;							//direction the recording drove in when it hit
+	unsigned int levels = sampler_isRunning() ? dio_getInputs() : dio_sample();	//levels of the untracked pins, which are written directly
+	impact_poll();									//forget collisions from before the replay
 
 	//continue to feed motor values until the end of the file
 	if(file != NULL)
 		while(!feof(file)){
 
-			//set motor velocities
+			int events = impact_poll();	//collisions and tips since the last tick
+
+			//robot has tipped, stop everything
+			if(events & IMPACT_TIPPING)
+				break;
+
+			//read the recorded motor commands
 			for(int i = PORT_1; i <= PORT_10; i++)
-				motorSet(i, readMotorValue(file));
+				commands[i] = readMotorValue(file);
+
+			//robot has hit something, stop driving into it
+			if(events & IMPACT_COLLISION){
+				blocked = true;
+				hit = millis();
+				direction = replay_getDirection(commands);
+			}
+
+			//release the drive once the hit is over or the recording backs away from it
+			if(blocked && (millis() - hit >= IMPACT_HOLDOFF || replay_getDirection(commands) * direction < 0))
+				blocked = false;
+
+			//set motor commands, holding the drive after a hit and limited so the PTCs do not trip
+			for(int i = PORT_1; i <= PORT_10; i++){
+				int command = thermal_limit(i, blocked && replay_isDrive(i) ? 0 : commands[i]);	//command sent to the port
+				thermal_update(i, command);
+				motorSet(i, command);
+			}
 
-			//set digital pin statuses
+			unsigned int pins = 0;	//recorded digital pin statuses
+
+			//read digital pin statuses
+			for(int i = DGTL_1; i <= DGTL_12; i++)
+				if(readDigitalPortValue(file))
+					pins |= DIO_BIT(i);
+
+			//set the output pins that have changed
+			dio_setOutputs(pins, DIO_ALL);
+			dio_flush();
+
+			unsigned int untracked = DIO_ALL & ~(dio_getOutputPins() | dio_getInputPins());	//pins set up outside the digital I/O words
+
+			//write the untracked pins that have changed, as the recording read them directly
 			for(int i = DGTL_1; i <= DGTL_12; i++)
-				digitalWrite(i, readDigitalPortValue(file));
+				if((untracked & DIO_BIT(i)) && ((pins ^ levels) & DIO_BIT(i)))
+					dio_write(i, (pins & DIO_BIT(i)) != 0);
+			levels = (levels & ~untracked) | (pins & untracked);
 
 			delay(20);	//same delay as recording
 		}
-	motorStopAll();	//stop all motors
+	motorStopAll();				//stop all motors
+	thermal_report(stdout);	//report how hot the replay left the motors
 }
 
 /*
@@ -134,9 +231,11 @@ int readMotorValue(FILE* file){return (ctoi(fgetc(file))*16 + ctoi(fgetc(file))
 
 /*
  * Write the state of the digital port to the desired
- * file.
+ * file. The state comes from the digital I/O words, so
+ * the pins should be sampled once, by the sampler or by
+ * dio_sample, before the ports are written.
  */
-void writeDigitalPortValue(FILE* file, int port){fputc(itoc(digitalRead(port)), file);}
+void writeDigitalPortValue(FILE* file, int port){fputc(itoc(dio_get(port)), file);}
 
 /*
  * Retrieve the digital port value from a file.
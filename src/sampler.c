@@ -0,0 +1,433 @@
+/*
+ * @file sampler.c
+ *
+ * @brief Implementation of the sensor sampler. The sampler fills the
+ *		  back snapshot and then flips it to the front with a single
+ *		  write, so readers never see a half written snapshot. A reader
+ *		  that is held up for two ticks could still see its snapshot
+ *		  refilled, so the sampler counts every fill and flip and readers
+ *		  copy values out and retry if the snapshot they copied from may
+ *		  have been refilled.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sampler.h>
+#include <ime.h>
+#include <health.h>
+#include <dio.h>
+#include <driver.h>
+
+static Sensor samplerSensors[SAMPLER_SENSORS];									//registered sensors
+static volatile int samplerCount = SAMPLER_FIRST;								//slot after the last registered sensor
+static Snapshot samplerBuffers[2];															//front and back snapshots
+static volatile int samplerFront;																//index of the front snapshot
+static volatile unsigned int samplerSequence;										//number of fills started and flips made, odd while filling
+static volatile unsigned int samplerResets[SAMPLER_SENSORS];		//number of times each sensor value has been discarded
+static unsigned int samplerSeen[SAMPLER_SENSORS];								//discards the sampler has handled for each sensor
+static Filter samplerFilters[SAMPLER_FILTERS];									//filter chains
+static Filter* samplerChain[SAMPLER_SENSORS];										//filter chain owned by each sensor, NULL for none
+static Filter* volatile samplerFilter[SAMPLER_SENSORS];					//filter chain run on each sensor, NULL for none
+static int samplerFilterCount;																	//number of filter chains in use
+static Velocity samplerVelocities[SAMPLER_VELOCITIES];					//velocity estimators
+static Velocity* samplerVelocity[SAMPLER_SENSORS];							//velocity estimator of each sensor, NULL for none
+static int samplerVelocityCount;																//number of velocity estimators in use
+static TaskHandle samplerTask;																	//sampler task, NULL when stopped
+static unsigned long samplerPeriod;															//tick in milliseconds
+static unsigned long samplerReads;															//number of hardware reads
+
+/*
+ * Sampler task. Samples every registered sensor once per tick.
+ *
+ * @param ignore Unused task parameter.
+ */
+static void sampler_run(void* ignore){
+
+	unsigned long wake = millis();	//time of the last tick
+
+	//sample forever
+	while(true){
+		sampler_sample();
+		taskDelayUntil(&wake, samplerPeriod);
+	}
+}
+
+/*
+ * Start the sampler task. Does nothing if it is already running.
+ *
+ * @param period The tick in milliseconds.
+ */
+void sampler_start(unsigned long period){
+	samplerPeriod = period > 0 ? period : SAMPLER_PERIOD;	//set the tick
+
+	//start the task
+	if(samplerTask == NULL)
+		samplerTask = taskCreate(sampler_run, TASK_DEFAULT_STACK_SIZE, NULL, TASK_PRIORITY_DEFAULT + 1);
+}
+
+/*
+ * Stop the sampler task. Sensor values are read from the hardware
+ * until it is started again.
+ */
+void sampler_stop(){
+
+	//stop the task
+	if(samplerTask != NULL){
+		taskDelete(samplerTask);
+		samplerTask = NULL;
+	}
+}
+
+/*
+ * Check if the sampler task is running.
+ *
+ * @return If the sampler task is running.
+ */
+bool sampler_isRunning(){
+	return samplerTask != NULL;
+}
+
+/*
+ * Read every registered sensor once into the back snapshot and make
+ * it the front snapshot. The sampler task calls this every tick, it
+ * can also be called directly when the task is not running.
+ */
+void sampler_sample(){
+
+	Snapshot* front = &samplerBuffers[samplerFront];		//snapshot being read
+	Snapshot* back = &samplerBuffers[!samplerFront];		//snapshot being filled
+	int count = samplerCount;														//slot after the last sensor registered when the tick started
+	unsigned long reads = 2;														//hardware reads, starting with the two sweeps
+
+	samplerSequence++;	//start the fill
+
+	ime_sweep();		//read the whole IME chain at once
+	dio_sample();		//read every digital input at once
+
+	//read each sensor
+	for(int i = SAMPLER_FIRST; i < count; i++){
+		unsigned int resets = samplerResets[i];								//discards before the read
+		bool reset = samplerSeen[i] != resets;									//flag for the sensor having been reset
+		Filter* filter = samplerFilter[i];											//filter chain of the sensor
+		Velocity* velocity = samplerVelocity[i];								//velocity estimator of the sensor
+		int value = 0;																					//raw sensor value
+
+		const SensorDriver* driver = driver_get(samplerSensors[i].type);	//driver for the sensor type
+
+		//read through the driver, keeping the last good value on an error; IMEs and digital inputs come from the sweeps
+		if(driver != NULL){
+			bool good = driver->read(&samplerSensors[i], &value);					//flag for the read succeeding
+			value = health_update(i, good, value, driver_getFull(&samplerSensors[i]));
+			if(!driver_isSwept(samplerSensors[i].type))
+				reads++;
+		}
+		samplerSeen[i] = resets;
+
+		//estimate the velocity from the raw count, starting over if the sensor was reset
+		if(velocity != NULL){
+			if(reset)
+				velocity_reset(velocity);
+			velocity_update(velocity, value, micros());
+		}
+
+		//run the filter, starting over if the sensor was reset
+		if(filter != NULL){
+			if(reset)
+				filter_reset(filter);
+			value = filter_apply(filter, value);
+		}
+
+		back->values[i] = value;
+
+		//value was discarded while it was being read
+		back->stamps[i] = resets == samplerResets[i] ? micros() : 0;
+	}
+
+	back->tick = front->tick + 1;	//number the snapshot
+	samplerReads += reads;				//count the hardware reads
+	samplerFront = !samplerFront;	//publish the snapshot
+	samplerSequence++;						//finish the flip
+}
+
+/*
+ * Copy values and stamps out of the front snapshot, all from the same
+ * tick. A fill only writes the back snapshot, so the copy is only lost
+ * when the snapshot it came from has become the back and started to be
+ * refilled: two sequence steps after a copy started between ticks, or
+ * one after a copy started during a fill. The copy is retried then.
+ *
+ * @param ids The slots being copied, all registered.
+ * @param count The number of slots.
+ * @param values Where the values are stored.
+ * @param stamps Where the stamps are stored.
+ */
+static void sampler_copy(const int* ids, int count, int* values, unsigned long* stamps){
+
+	unsigned int sequence;	//sequence when the copy started
+
+	//copy until no refill overlapped the copy
+	do{
+		sequence = samplerSequence;
+		const Snapshot* front = &samplerBuffers[samplerFront];	//snapshot being copied
+
+		for(int i = 0; i < count; i++){
+			values[i] = front->values[ids[i]];
+			stamps[i] = front->stamps[ids[i]];
+		}
+	} while(samplerSequence - sequence > ((sequence & 1) ? 1 : 2));
+}
+
+/*
+ * Register a sensor with the sampler. Output sensors are not sampled.
+ *
+ * @param sensor The sensor being registered.
+ * @return The slot of the sensor, -1 if it is not sampled.
+ */
+int sampler_register(const Sensor* sensor){
+
+	//output sensors and full sampler are read from the hardware
+	if(sensor->type == LED || sensor->type == SOL || samplerCount >= SAMPLER_SENSORS)
+		return -1;
+
+	int id = samplerCount;								//slot of the new sensor
+	samplerSensors[id] = *sensor;					//copy the sensor before it is visible
+	samplerSensors[id].id = id;
+	samplerChain[id] = NULL;							//unfiltered
+	samplerFilter[id] = NULL;
+	samplerVelocity[id] = NULL;						//no velocity estimate
+	samplerSeen[id] = samplerResets[id];
+	health_reset(id);											//start monitoring before the sampler can update it
+
+	//quadrature encoders have their velocity estimated, the IME sweep estimates its own
+	if(sensor->type == QME && samplerVelocityCount < SAMPLER_VELOCITIES){
+		samplerVelocities[samplerVelocityCount] = velocity_init();
+		samplerVelocity[id] = &samplerVelocities[samplerVelocityCount++];
+	}
+
+	samplerBuffers[0].stamps[id] = 0;			//no value until the next tick
+	samplerBuffers[1].stamps[id] = 0;
+	samplerCount = id + 1;								//make the sensor visible to the sampler
+
+	return id;
+}
+
+/*
+ * Update the copy of a registered sensor after it has changed, for
+ * example after its direction has been reversed.
+ *
+ * @param sensor The sensor that has changed.
+ */
+void sampler_update(const Sensor* sensor){
+	if(sensor->id >= SAMPLER_FIRST && sensor->id < samplerCount)
+		samplerSensors[sensor->id] = *sensor;
+}
+
+/*
+ * Discard the sampled value of a sensor, for example after it has been
+ * reset, so it is read from the hardware until the next tick.
+ *
+ * @param id The slot of the sensor.
+ */
+void sampler_invalidate(int id){
+
+	//sensor is not registered
+	if(id < SAMPLER_FIRST || id >= samplerCount)
+		return;
+
+	samplerResets[id]++;	//discard a read in progress
+	samplerBuffers[0].stamps[id] = 0;
+	samplerBuffers[1].stamps[id] = 0;
+}
+
+/*
+ * Set the filter run on every sample of a sensor. The filter is copied
+ * into the sampler, which keeps its state between samples. An empty
+ * filter removes filtering from the sensor.
+ *
+ * @param id The slot of the sensor.
+ * @param filter The filter being copied.
+ * @return If the sensor is sampled and a filter chain was available.
+ */
+bool sampler_setFilter(int id, const Filter* filter){
+
+	//sensor is not registered
+	if(id < SAMPLER_FIRST || id >= samplerCount)
+		return false;
+
+	Filter* chain = samplerChain[id];	//chain of the sensor
+
+	//take a free chain
+	if(chain == NULL){
+		if(samplerFilterCount >= SAMPLER_FILTERS)
+			return false;
+		chain = &samplerFilters[samplerFilterCount++];
+		samplerChain[id] = chain;
+	}
+
+	samplerFilter[id] = NULL;		//stop filtering while the chain is replaced
+	*chain = *filter;
+	filter_reset(chain);
+
+	//filter is not empty
+	if(chain->size > 0)
+		samplerFilter[id] = chain;
+
+	return true;
+}
+
+/*
+ * Remove every registered sensor and filter.
+ */
+void sampler_clear(){
+	samplerCount = SAMPLER_FIRST;
+	samplerFilterCount = 0;
+	samplerVelocityCount = 0;
+}
+
+/*
+ * Retrieve a sensor value from the latest snapshot. Values are only
+ * retrieved while the sampler task is running, since the snapshot is
+ * not refreshed otherwise.
+ *
+ * @param id The slot of the sensor.
+ * @param value Where the value is stored.
+ * @return If the sensor has a sampled value.
+ */
+bool sampler_getValue(int id, int* value){
+	bool sampled;	//flag for the sensor having a sampled value
+
+	sampler_getValues(&id, value, &sampled, 1);
+	return sampled;
+}
+
+/*
+ * Retrieve several sensor values from the latest snapshot, all from
+ * the same tick. The values are copied out, so they stay consistent
+ * however long the caller holds them. Slots without a sampled value
+ * are flagged and their values are left unchanged.
+ *
+ * @param ids The slots of the sensors.
+ * @param values Where the values are stored.
+ * @param sampled Where the flag for each sensor having a sampled value is stored.
+ * @param count The number of sensors, at most SAMPLER_SENSORS.
+ * @return If any sensor has a sampled value.
+ */
+bool sampler_getValues(const int* ids, int* values, bool* sampled, int count){
+
+	int slots[SAMPLER_SENSORS];								//registered slots being copied
+	int copy[SAMPLER_SENSORS];								//copy of each sensor, -1 if it is not registered
+	int copied[SAMPLER_SENSORS];							//values copied
+	unsigned long stamps[SAMPLER_SENSORS];		//stamps copied
+	int size = 0;															//number of registered slots
+	int registered = samplerCount;						//slot after the last registered sensor
+	bool any = false;													//flag for any sensor having a sampled value
+
+	//too many sensors
+	if(count > SAMPLER_SENSORS)
+		count = SAMPLER_SENSORS;
+
+	//sampler is stopped, nothing has been sampled
+	if(!sampler_isRunning()){
+		for(int i = 0; i < count; i++)
+			sampled[i] = false;
+		return false;
+	}
+
+	//take the registered slots
+	for(int i = 0; i < count; i++){
+		copy[i] = -1;
+		if(ids[i] >= SAMPLER_FIRST && ids[i] < registered){
+			copy[i] = size;
+			slots[size++] = ids[i];
+		}
+	}
+
+	sampler_copy(slots, size, copied, stamps);
+
+	//hand out the values that have been sampled
+	for(int i = 0; i < count; i++){
+		sampled[i] = copy[i] >= 0 && stamps[copy[i]] != 0;
+
+		//sensor has been sampled
+		if(sampled[i]){
+			values[i] = copied[copy[i]];
+			any = true;
+		}
+	}
+
+	return any;
+}
+
+/*
+ * Retrieve the time a sensor value in the latest snapshot was read.
+ *
+ * @param id The slot of the sensor.
+ * @return The time in microseconds, 0 if it has not been sampled.
+ */
+unsigned long sampler_getStamp(int id){
+
+	int value;						//value copied with the stamp
+	unsigned long stamp;	//stamp of the value
+
+	//sensor is not registered
+	if(id < SAMPLER_FIRST || id >= samplerCount)
+		return 0;
+
+	sampler_copy(&id, 1, &value, &stamp);
+	return stamp;
+}
+
+/*
+ * Retrieve the estimated velocity of an encoder.
+ *
+ * @param id The slot of the sensor.
+ * @return The velocity in counts per second, 0 if it is not estimated.
+ */
+int sampler_getVelocity(int id){
+
+	//sensor is not registered or has no velocity estimate
+	if(id < SAMPLER_FIRST || id >= samplerCount || samplerVelocity[id] == NULL)
+		return 0;
+
+	return velocity_get(samplerVelocity[id]);
+}
+
+/*
+ * Retrieve the estimated acceleration of an encoder.
+ *
+ * @param id The slot of the sensor.
+ * @return The acceleration in counts per second squared, 0 if it is not estimated.
+ */
+int sampler_getAcceleration(int id){
+
+	//sensor is not registered or has no velocity estimate
+	if(id < SAMPLER_FIRST || id >= samplerCount || samplerVelocity[id] == NULL)
+		return 0;
+
+	return velocity_getAcceleration(samplerVelocity[id]);
+}
+
+/*
+ * Retrieve the number of hardware reads the sampler has made. This is
+ * the sensor bus traffic caused by the sampler: one read for each
+ * sensor read through its driver, and one for each IME and digital
+ * input sweep, which serve every sensor on them.
+ *
+ * @return The number of hardware reads.
+ */
+unsigned long sampler_getReads(){
+	return samplerReads;
+}
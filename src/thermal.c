@@ -0,0 +1,357 @@
+/*
+ * @file thermal.c
+ *
+ * @brief Implementation of the motor PTC thermal model. The PTC heats
+ *		  with the square of the motor current and cools towards ambient
+ *		  with a single time constant. The thermal task integrates every
+ *		  port over the time since its last step using the command the
+ *		  port holds, so a motor held at a constant command keeps heating.
+ *		  The task is the only writer of the model; other tasks only
+ *		  record commands and measured speeds.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <thermal.h>
+
+static Thermal thermal[10];				//thermal state of motor ports one through ten
+static TaskHandle thermalTask;				//thermal task, NULL when stopped
+static unsigned long thermalPeriod;		//integration period in milliseconds
+
+/*
+ * Retrieve the thermal state of a motor port.
+ *
+ * @param port The motor port.
+ * @return The thermal state, or NULL for an invalid port.
+ */
+static Thermal* thermal_get(int port){
+
+	//invalid port
+	if(port < 1 || port > 10)
+		return NULL;
+
+	return &thermal[port - 1];
+}
+
+/*
+ * Estimate the motor current for a commanded velocity.
+ *
+ * @param state The thermal state of the motor.
+ * @param command The commanded velocity.
+ * @return The estimated current in mA.
+ */
+static int thermal_current(Thermal* state, int command){
+
+	//a tripped PTC does not conduct
+	if(state->tripped)
+		return 0;
+
+	int drive = command - fixed_toInt(state->speed);	//velocity not cancelled by back EMF
+
+	return (int64_t)abs(drive) * THERMAL_STALL_CURRENT * powerLevelMain() / (127 * THERMAL_NOMINAL_VOLT);
+}
+
+/*
+ * Thermal task. Integrates the model once per period.
+ *
+ * @param ignore Unused task parameter.
+ */
+static void thermal_run(void* ignore){
+
+	unsigned long wake = millis();	//time of the last step
+
+	//integrate forever
+	while(true){
+		thermal_step();
+		taskDelayUntil(&wake, thermalPeriod);
+	}
+}
+
+/*
+ * Integrate the model of a motor port up to now using the command the
+ * port holds.
+ *
+ * @param state The thermal state of the port.
+ * @param now The current time in milliseconds.
+ */
+static void thermal_integrate(Thermal* state, unsigned long now){
+
+	long dt = now - state->lastUpdate;	//time since the last step
+	int command = state->command;				//command held over the step
+	state->lastUpdate = now;
+
+	//large gaps would make the integration unstable
+	if(dt > THERMAL_TAU)
+		dt = THERMAL_TAU;
+
+	//use the measured speed while it is recent
+	if(state->measuredAt != 0 && now - state->measuredAt <= THERMAL_MEASURED)
+		state->speed = fixed_fromInt(state->measured);
+
+	//estimate the speed from the command
+	else{
+		Fixed target = fixed_mulInt(THERMAL_LOAD, command);
+		long k = dt < THERMAL_SPEED_TAU ? dt : THERMAL_SPEED_TAU;
+		state->speed += (int64_t)(target - state->speed) * k / THERMAL_SPEED_TAU;
+	}
+
+	//steady state rise for the current, then move towards it
+	Fixed current = fixed_fromInt(thermal_current(state, command)) / 1000;
+	Fixed target = fixed_mulInt(fixed_mul(current, current), (THERMAL_TRIP - THERMAL_AMBIENT) * 1000000 / ((int64_t)THERMAL_HOLD_CURRENT * THERMAL_HOLD_CURRENT));
+	state->rise += (int64_t)(target - state->rise) * dt / THERMAL_TAU;
+
+	//PTC has tripped
+	if(!state->tripped && state->rise >= fixed_fromInt(THERMAL_TRIP - THERMAL_AMBIENT)){
+		state->tripped = true;
+		state->trips++;
+	}
+
+	//PTC has cooled enough to reset
+	else if(state->tripped && state->rise < fixed_fromInt(THERMAL_TRIP - THERMAL_HYSTERESIS - THERMAL_AMBIENT))
+		state->tripped = false;
+}
+
+/*
+ * Start the thermal task. Does nothing if it is already running.
+ *
+ * @param period The integration period in milliseconds.
+ */
+void thermal_start(unsigned long period){
+
+	//already running
+	if(thermalTask != NULL)
+		return;
+
+	thermalPeriod = period > 0 ? period : THERMAL_PERIOD;	//set the period
+
+	//start integrating from now
+	for(int i = 0; i < 10; i++)
+		thermal[i].lastUpdate = millis();
+
+	thermalTask = taskCreate(thermal_run, TASK_DEFAULT_STACK_SIZE, NULL, TASK_PRIORITY_DEFAULT + 1);
+}
+
+/*
+ * Stop the thermal task. The model keeps its last state.
+ */
+void thermal_stop(){
+
+	//stop the task
+	if(thermalTask != NULL){
+		taskDelete(thermalTask);
+		thermalTask = NULL;
+	}
+}
+
+/*
+ * Integrate the model of every motor port up to now. The thermal task
+ * calls this every period, it can also be called directly when the
+ * task is not running.
+ */
+void thermal_step(){
+
+	unsigned long now = millis();	//time of the step
+
+	//integrate each port
+	for(int i = 0; i < 10; i++)
+		thermal_integrate(&thermal[i], now);
+}
+
+/*
+ * Record the command sent to a motor port. The port is modelled as
+ * holding the command until the next one.
+ *
+ * @param port The motor port.
+ * @param command The command sent to the port.
+ */
+void thermal_update(int port, int command){
+
+	Thermal* state = thermal_get(port);	//thermal state of the port
+
+	//invalid port
+	if(state == NULL)
+		return;
+
+	state->command = command;
+}
+
+/*
+ * Set the measured speed of the motor. It replaces the speed estimated
+ * from the command for THERMAL_MEASURED ms.
+ *
+ * @param port The motor port.
+ * @param speed The motor speed scaled to command units (-127 to 127).
+ */
+void thermal_setSpeed(int port, int speed){
+
+	Thermal* state = thermal_get(port);	//thermal state of the port
+
+	//invalid port
+	if(state == NULL)
+		return;
+
+	state->measured = speed;
+	state->measuredAt = millis() > 0 ? millis() : 1;
+}
+
+/*
+ * Limit a command so that the estimated current lets the PTC cool
+ * before it trips. No limit is applied below THERMAL_LIMIT, and the
+ * limit tightens until the current is held just under the hold current
+ * at THERMAL_MARGIN below the trip temperature. A command is never
+ * raised in magnitude, so motors can always be slowed or stopped.
+ *
+ * @param port The motor port.
+ * @param command The desired port command, after linearisation and reversal.
+ * @return The limited command.
+ */
+int thermal_limit(int port, int command){
+
+	Thermal* state = thermal_get(port);	//thermal state of the port
+
+	//invalid port
+	if(state == NULL)
+		return command;
+
+	//PTC is tripped, the motor has no power
+	if(state->tripped)
+		return 0;
+
+	int temperature = thermal_getTemperature(port);																		//current temperature
+	int hold = 127 * THERMAL_HOLD_CURRENT * 9 / (10 * THERMAL_STALL_CURRENT);				//drive at 90% of hold current
+	int span = THERMAL_TRIP - THERMAL_MARGIN - THERMAL_LIMIT;													//limiting temperature span
+	int allowed = 127;																																//allowed drive
+
+	//limit the drive
+	if(temperature >= THERMAL_TRIP - THERMAL_MARGIN)
+		allowed = hold;
+	else if(temperature > THERMAL_LIMIT)
+		allowed = 127 - (127 - hold) * (temperature - THERMAL_LIMIT) / span;
+
+	int speed = fixed_toInt(state->speed);	//current motor speed
+	int limited = command;									//command inside the allowed drive
+
+	if(limited > speed + allowed)
+		limited = speed + allowed;
+	else if(limited < speed - allowed)
+		limited = speed - allowed;
+
+	//never reverse the command
+	if((limited < 0 && command > 0) || (limited > 0 && command < 0))
+		return 0;
+
+	//never raise the magnitude of the command
+	else if(abs(limited) > abs(command))
+		return command;
+
+	return limited;
+}
+
+/*
+ * Retrieve the estimated PTC temperature of the motor port.
+ *
+ * @param port The motor port.
+ * @return The temperature in degrees C.
+ */
+int thermal_getTemperature(int port){
+
+	Thermal* state = thermal_get(port);	//thermal state of the port
+
+	//invalid port
+	if(state == NULL)
+		return THERMAL_AMBIENT;
+
+	return THERMAL_AMBIENT + fixed_toInt(state->rise);
+}
+
+/*
+ * Retrieve the estimated current of the motor port for its last
+ * commanded velocity.
+ *
+ * @param port The motor port.
+ * @return The current in mA.
+ */
+int thermal_getCurrent(int port){
+
+	Thermal* state = thermal_get(port);	//thermal state of the port
+
+	//invalid port
+	if(state == NULL)
+		return 0;
+
+	return thermal_current(state, state->command);
+}
+
+/*
+ * Check if the PTC of the motor port is estimated to be tripped.
+ *
+ * @param port The motor port.
+ * @return If the PTC is tripped.
+ */
+bool thermal_isTripped(int port){
+
+	Thermal* state = thermal_get(port);	//thermal state of the port
+
+	return state != NULL && state->tripped;
+}
+
+/*
+ * Retrieve the number of times the PTC of the motor port is
+ * estimated to have tripped.
+ *
+ * @param port The motor port.
+ * @return The number of trips.
+ */
+unsigned int thermal_getTrips(int port){
+
+	Thermal* state = thermal_get(port);	//thermal state of the port
+
+	return state != NULL ? state->trips : 0;
+}
+
+/*
+ * Retrieve the motor port with the hottest PTC.
+ *
+ * @return The hottest motor port.
+ */
+int thermal_getHottest(){
+
+	int hottest = 1;	//hottest port found
+
+	//search for the hottest port
+	for(int i = 2; i <= 10; i++)
+		if(thermal[i - 1].rise > thermal[hottest - 1].rise)
+			hottest = i;
+
+	return hottest;
+}
+
+/*
+ * Write the estimated temperature of every motor port as a single
+ * telemetry line. Tripped ports are marked with an asterisk.
+ *
+ * @param stream The stream the line is written to.
+ */
+void thermal_report(FILE* stream){
+
+	fprintf(stream, "PTC");
+
+	//write each port
+	for(int i = 1; i <= 10; i++)
+		fprintf(stream, " %d%s", thermal_getTemperature(i), thermal_isTripped(i) ? "*" : "");
+
+	fprintf(stream, "\r\n");
+}
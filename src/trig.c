@@ -0,0 +1,170 @@
+/*
+ * @file trig.c
+ *
+ * @brief Implementation of the fixed-point trigonometry. The tables
+ *		  are generated into trig_tables.h by tools/gentrig.py when the
+ *		  project is built. They are const so the linker places them in
+ *		  flash rather than RAM, and hold values rounded to Q16.16 from:
+ *
+ *		  trigSine[i]		sin(i degrees), i = 0 to 90
+ *		  trigArctan[i]		atan(i / 64) in degrees, i = 0 to 64
+ *		  trigRoot[i]		sqrt((i + 32) / 128), i = 0 to 96
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <trig.h>
+
+#include "trig_tables.h"
+
+/*
+ * Look up the sine of an angle from 0 to 90 degrees.
+ *
+ * @param angle The fixed-point angle in degrees.
+ * @return The fixed-point sine.
+ */
+static Fixed trig_quarter(Fixed angle){
+
+	int index = angle >> FIXED_SHIFT;					//whole degrees
+	int fraction = angle & (FIXED_ONE - 1);		//fraction of a degree
+
+	//end of the table
+	if(index >= 90)
+		return trigSine[90];
+
+	return trigSine[index] + (((int64_t)(trigSine[index + 1] - trigSine[index]) * fraction) >> FIXED_SHIFT);
+}
+
+/*
+ * Look up the arctangent of a ratio from 0 to 1.
+ *
+ * @param ratio The fixed-point ratio.
+ * @return The fixed-point arctangent in degrees.
+ */
+static Fixed trig_arctan(Fixed ratio){
+
+	int index = ratio >> (FIXED_SHIFT - 6);						//whole 64ths
+	int fraction = ratio & ((FIXED_ONE >> 6) - 1);		//fraction of a 64th
+
+	//end of the table
+	if(index >= 64)
+		return trigArctan[64];
+
+	return trigArctan[index] + (((trigArctan[index + 1] - trigArctan[index]) * fraction) >> (FIXED_SHIFT - 6));
+}
+
+/*
+ * Compute the sine of an angle.
+ *
+ * @param angle The fixed-point angle in degrees.
+ * @return The fixed-point sine.
+ */
+Fixed trig_sin(Fixed angle){
+
+	//wrap the angle to 0 to 360 degrees
+	angle %= fixed_fromInt(360);
+	if(angle < 0)
+		angle += fixed_fromInt(360);
+
+	//sine is negative and mirrored from 180 to 360 degrees
+	if(angle >= fixed_fromInt(180))
+		return -trig_sin(angle - fixed_fromInt(180));
+
+	//sine is mirrored about 90 degrees
+	if(angle > fixed_fromInt(90))
+		angle = fixed_fromInt(180) - angle;
+
+	return trig_quarter(angle);
+}
+
+/*
+ * Compute the cosine of an angle.
+ *
+ * @param angle The fixed-point angle in degrees.
+ * @return The fixed-point cosine.
+ */
+Fixed trig_cos(Fixed angle){
+	return trig_sin(angle % fixed_fromInt(360) + fixed_fromInt(90));
+}
+
+/*
+ * Compute the angle of a vector, the arctangent of y over x in the
+ * correct quadrant.
+ *
+ * @param y The fixed-point y component.
+ * @param x The fixed-point x component.
+ * @return The fixed-point angle in degrees from -180 to 180, 0 for a zero vector.
+ */
+Fixed trig_atan2(Fixed y, Fixed x){
+
+	int64_t ax = x < 0 ? -(int64_t)x : x;	//magnitude of x
+	int64_t ay = y < 0 ? -(int64_t)y : y;	//magnitude of y
+	Fixed angle;													//angle in the first quadrant
+
+	//zero vector
+	if(ax == 0 && ay == 0)
+		return 0;
+
+	//keep the ratio from 0 to 1
+	if(ay <= ax)
+		angle = trig_arctan((ay << FIXED_SHIFT) / ax);
+	else
+		angle = fixed_fromInt(90) - trig_arctan((ax << FIXED_SHIFT) / ay);
+
+	//move the angle into the quadrant of the vector
+	if(x < 0)
+		angle = fixed_fromInt(180) - angle;
+	if(y < 0)
+		angle = -angle;
+
+	return angle;
+}
+
+/*
+ * Compute the square root. The value is scaled by a power of four into
+ * the table range and the root is scaled back by the matching power of
+ * two.
+ *
+ * @param value The fixed-point value.
+ * @return The fixed-point square root, 0 for values that are not positive.
+ */
+Fixed trig_sqrt(Fixed value){
+
+	//no real root
+	if(value <= 0)
+		return 0;
+
+	uint32_t scaled = value;	//value scaled into 0.25 to 1 of the full range
+	int shift = 0;						//powers of two the value was scaled by
+
+	//scale by powers of four
+	while(scaled < 0x40000000){
+		scaled <<= 2;
+		shift += 2;
+	}
+
+	int index = (scaled >> 25) - 32;							//whole 128ths above 0.25
+	int fraction = (scaled >> 9) & (FIXED_ONE - 1);	//fraction of a 128th
+	uint32_t root = trigRoot[index];							//root of the scaled value
+
+	//interpolate
+	if(index < 96)
+		root += ((uint64_t)(trigRoot[index + 1] - trigRoot[index]) * fraction) >> FIXED_SHIFT;
+
+	//the scaled value is the value times 2^(16 + shift), so the root is scaled by 2^(8 + shift / 2)
+	shift = shift / 2 - 8;
+	return shift >= 0 ? (Fixed)(root >> shift) : (Fixed)(root << -shift);
+}
@@ -0,0 +1,167 @@
+/*
+ * @file velocity.c
+ *
+ * @brief Implementation of the encoder velocity estimator. Only one
+ *		  64-bit division is made per sample for the velocity, so an
+ *		  update costs a few microseconds on the Cortex.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <velocity.h>
+
+/*
+ * Retrieve the position in the history of an older sample.
+ *
+ * @param target The estimator being accessed.
+ * @param age The number of samples before the newest.
+ * @return The position of the sample.
+ */
+static int velocity_at(Velocity* target, int age){
+	return (target->index - age + VELOCITY_HISTORY) % VELOCITY_HISTORY;
+}
+
+/*
+ * Estimate the velocity from the history.
+ *
+ * @param target The estimator being accessed.
+ * @return The velocity in counts per second.
+ */
+static int velocity_estimate(Velocity* target){
+
+	int edge = 0;	//age of the newest sample the count changed on
+
+	//find the last change in count
+	while(edge + 1 < target->size && target->counts[velocity_at(target, edge)] == target->counts[velocity_at(target, edge + 1)])
+		edge++;
+
+	//count has not changed
+	if(edge + 1 >= target->size)
+		return 0;
+
+	unsigned long now = target->stamps[target->index];							//time of the newest sample
+	int end = target->counts[velocity_at(target, edge)];						//count at the end of the window
+	unsigned long endStamp = target->stamps[velocity_at(target, edge)];	//time at the end of the window
+
+	//motion is too slow to measure
+	if(now - endStamp >= VELOCITY_WINDOW)
+		return 0;
+
+	int start = edge + 1;	//age of the sample the window starts on
+
+	//grow the window until it holds enough counts or is too long
+	while(start + 1 < target->size && abs(end - target->counts[velocity_at(target, start)]) < VELOCITY_COUNTS && endStamp - target->stamps[velocity_at(target, start)] < VELOCITY_WINDOW)
+		start++;
+
+	int counts = end - target->counts[velocity_at(target, start)];							//counts in the window
+	unsigned long span = endStamp - target->stamps[velocity_at(target, start)];	//length of the window
+
+	//no motion across the window
+	if(counts == 0 || span == 0)
+		return 0;
+
+	int velocity = (int64_t)counts * 1000000 / (long)span;	//velocity over the window
+
+	//a count is overdue, so the encoder is moving slower than the window shows
+	unsigned long since = now - endStamp;	//time since the last change in count
+	if(since > 0 && (int64_t)abs(velocity) * since > 1000000)
+		velocity = velocity > 0 ? 1000000 / since : -(int)(1000000 / since);
+
+	return velocity;
+}
+
+/*
+ * Initialize an empty estimator.
+ *
+ * @return The estimator being initialized.
+ */
+Velocity velocity_init(){
+	Velocity tmp;					//estimator being returned
+	velocity_reset(&tmp);	//no samples
+
+	return tmp;
+}
+
+/*
+ * Forget every sample. This should be done when the encoder is reset.
+ *
+ * @param target The estimator being manipulated.
+ */
+void velocity_reset(Velocity* target){
+	target->index = 0;
+	target->size = 0;
+	target->velocity = 0;
+	target->acceleration = 0;
+	target->lastVelocity = 0;
+	target->lastStamp = 0;
+}
+
+/*
+ * Add a sample to the history and estimate the velocity and
+ * acceleration. Samples should be added at a steady rate.
+ *
+ * @param target The estimator being manipulated.
+ * @param count The encoder count.
+ * @param stamp The time of the sample in microseconds.
+ * @return The velocity in counts per second.
+ */
+int velocity_update(Velocity* target, int count, unsigned long stamp){
+
+	//record the sample
+	target->index = (target->index + 1) % VELOCITY_HISTORY;
+	target->counts[target->index] = count;
+	target->stamps[target->index] = stamp;
+	if(target->size < VELOCITY_HISTORY)
+		target->size++;
+
+	target->velocity = velocity_estimate(target);
+
+	//first sample starts the acceleration window
+	if(target->size == 1){
+		target->lastVelocity = target->velocity;
+		target->lastStamp = stamp;
+	}
+
+	//acceleration window is complete
+	else if(stamp - target->lastStamp >= VELOCITY_ACCEL){
+		target->acceleration = (int64_t)(target->velocity - target->lastVelocity) * 1000000 / (long)(stamp - target->lastStamp);
+		target->lastVelocity = target->velocity;
+		target->lastStamp = stamp;
+	}
+
+	return target->velocity;
+}
+
+/*
+ * Retrieve the estimated velocity.
+ *
+ * @param target The estimator being accessed.
+ * @return The velocity in counts per second.
+ */
+int velocity_get(Velocity* target){
+	return target->velocity;
+}
+
+/*
+ * Retrieve the estimated acceleration. It is measured over
+ * VELOCITY_ACCEL so it is not swamped by count noise.
+ *
+ * @param target The estimator being accessed.
+ * @return The acceleration in counts per second squared.
+ */
+int velocity_getAcceleration(Velocity* target){
+	return target->acceleration;
+}
@@ -0,0 +1,160 @@
+/*
+ * @file bench_filter.c
+ *
+ * @brief Host benchmark of each filter stage, run one at a time and as
+ *		  a full chain over a noisy analog signal, reported per sample.
+ *		  The median sorts its whole window on every sample, so it is
+ *		  the stage to watch as the window grows. Each filter must also
+ *		  settle on a constant input, or the test fails.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <filter.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT "cycles"
+#else
+#define BENCH_UNIT "ns"
+#endif
+
+#define BENCH_SAMPLES 1000000	//samples timed for each filter
+#define BENCH_SETTLE  200			//samples of a constant input a filter has to settle
+#define BENCH_LEVEL   2000		//constant input the filters settle on
+
+static int failures;	//number of filters that did not settle
+
+/*
+ * Read the time stamp counter, or the monotonic clock where there is
+ * no counter.
+ *
+ * @return The current time in BENCH_UNIT.
+ */
+static unsigned long long bench_now(){
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (unsigned long long)now.tv_sec * 1000000000ull + now.tv_nsec;
+#endif
+}
+
+/*
+ * Generate a sample of a slow analog ramp with noise and the odd spike,
+ * from a fixed seed so every run is the same.
+ *
+ * @param i The number of the sample.
+ * @return The sample, from 0 to 4095.
+ */
+static int bench_signal(int i){
+
+	static unsigned int seed = 12345;	//noise generator state
+
+	seed = seed * 1103515245 + 12345;
+	int noise = (int)((seed >> 16) & 63) - 32;	//noise of about a 32 count swing
+
+	//spike every so often
+	if(((seed >> 8) & 255) == 0)
+		noise += 1000;
+
+	int value = (i / 64) % 4096 + noise;
+
+	return value < 0 ? 0 : value > 4095 ? 4095 : value;
+}
+
+/*
+ * Time a filter over the noisy signal, then check that it settles on a
+ * constant input.
+ *
+ * @param name The name of the filter.
+ * @param filter The filter being timed.
+ */
+static void bench_filter(const char* name, Filter filter){
+
+	volatile int sink;	//keeps the timed loop from being optimised away
+	unsigned long long start, time;
+
+	filter_reset(&filter);
+
+	//time the filter
+	start = bench_now();
+	for(int i = 0; i < BENCH_SAMPLES; i++)
+		sink = filter_apply(&filter, bench_signal(i));
+	time = bench_now() - start;
+
+	//settle on a constant
+	for(int i = 0; i < BENCH_SETTLE; i++)
+		sink = filter_apply(&filter, BENCH_LEVEL);
+
+	bool settled = sink == BENCH_LEVEL;	//flag for the filter settling
+	printf("%s %s: %.1f %s per sample\n", settled ? "PASS" : "FAIL", name, (double)time / BENCH_SAMPLES, BENCH_UNIT);
+
+	//filter did not settle
+	if(!settled)
+		failures++;
+}
+
+int main(){
+
+	Filter filter;		//filter being built
+	unsigned long long start, time;
+	volatile int sink;
+
+	//signal alone, so it can be taken off the times below
+	start = bench_now();
+	for(int i = 0; i < BENCH_SAMPLES; i++)
+		sink = bench_signal(i);
+	time = bench_now() - start;
+	printf("signal: %.1f %s per sample\n", (double)time / BENCH_SAMPLES, BENCH_UNIT);
+	(void)sink;
+
+	filter = filter_init();
+	filter_addAverage(&filter, FILTER_WINDOW);
+	bench_filter("moving average", filter);
+
+	filter = filter_init();
+	filter_addMedian(&filter, 3);
+	bench_filter("median of 3", filter);
+
+	filter = filter_init();
+	filter_addMedian(&filter, FILTER_WINDOW);
+	bench_filter("median of 7", filter);
+
+	filter = filter_init();
+	filter_addEMA(&filter, FIXED(0.2));
+	bench_filter("ema", filter);
+
+	filter = filter_init();
+	filter_addDeadband(&filter, 8);
+	bench_filter("deadband", filter);
+
+	filter = filter_init();
+	filter_addRate(&filter, 50);
+	bench_filter("rate limit", filter);
+
+	//full chain, as a noisy potentiometer would use it
+	filter = filter_init();
+	filter_addMedian(&filter, 3);
+	filter_addAverage(&filter, 4);
+	filter_addEMA(&filter, FIXED(0.5));
+	filter_addDeadband(&filter, 4);
+	bench_filter("median, average, ema, deadband", filter);
+
+	return failures == 0 ? 0 : 1;
+}
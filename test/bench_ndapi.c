@@ -0,0 +1,117 @@
+/*
+ * @file bench_ndapi.c
+ *
+ * @brief Host benchmark of the by-value NDAPI accessors against their
+ *		  Ref variants, which take a const pointer instead of copying the
+ *		  structure. sensor_getValue copies a whole Sensor on every call
+ *		  and motorSystem_getSize a whole MotorSystem. The sensor is read
+ *		  through its driver from the hardware stand-ins, since the
+ *		  sampler task does not run on the host, so both versions pay
+ *		  the same read and the gap is the copy and the extra call.
+ *		  motorSystem_getSizeRef is inline in NDAPI.h, so its loop folds
+ *		  away entirely while the by-value version is still a call. The
+ *		  test fails if a version returns a different value.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <NDAPI.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT "cycles"
+#else
+#define BENCH_UNIT "ns"
+#endif
+
+#define BENCH_CALLS 1000000	//calls timed for each function
+
+static int failures;	//number of mismatched results
+
+/*
+ * Read the time stamp counter, or the monotonic clock where there is
+ * no counter.
+ *
+ * @return The current time in BENCH_UNIT.
+ */
+static unsigned long long bench_now(){
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (unsigned long long)now.tv_sec * 1000000000ull + now.tv_nsec;
+#endif
+}
+
+/*
+ * Report the time of both versions of an accessor and check that they
+ * returned the same total.
+ *
+ * @param name The name of the accessor.
+ * @param value The time of the by-value version.
+ * @param ref The time of the Ref version.
+ * @param same If both versions returned the same total.
+ */
+static void bench_report(const char* name, unsigned long long value, unsigned long long ref, bool same){
+	printf("%s %s: value %.1f %s, ref %.1f %s\n", same ? "PASS" : "FAIL", name, (double)value / BENCH_CALLS, BENCH_UNIT, (double)ref / BENCH_CALLS, BENCH_UNIT);
+
+	//versions disagree
+	if(!same)
+		failures++;
+}
+
+int main(){
+
+	Sensor sensor = sensor_init(POT, 1);	//sensor read through its driver
+	Motor m1 = motor_init(PORT_1, false);
+	Motor m2 = motor_init(PORT_2, true);
+	MotorSystem system = motorSystem_init(2, &m1, &m2);
+
+	unsigned long long start, value, ref;
+	long long valueSum, refSum;		//results, so the calls are not optimised away
+
+	printf("sizeof(Sensor) %d, sizeof(MotorSystem) %d\n", (int)sizeof(Sensor), (int)sizeof(MotorSystem));
+
+	//time the sensor value
+	valueSum = 0;
+	start = bench_now();
+	for(int i = 0; i < BENCH_CALLS; i++)
+		valueSum += sensor_getValue(sensor);
+	value = bench_now() - start;
+	refSum = 0;
+	start = bench_now();
+	for(int i = 0; i < BENCH_CALLS; i++)
+		refSum += sensor_getValueRef(&sensor);
+	ref = bench_now() - start;
+	bench_report("sensor_getValue", value, ref, valueSum == refSum);
+
+	//time the motor system size
+	valueSum = 0;
+	start = bench_now();
+	for(int i = 0; i < BENCH_CALLS; i++)
+		valueSum += motorSystem_getSize(system);
+	value = bench_now() - start;
+	refSum = 0;
+	start = bench_now();
+	for(int i = 0; i < BENCH_CALLS; i++)
+		refSum += motorSystem_getSizeRef(&system);
+	ref = bench_now() - start;
+	bench_report("motorSystem_getSize", value, ref, valueSum == refSum && refSum == 2LL * BENCH_CALLS);
+
+	return failures == 0 ? 0 : 1;
+}
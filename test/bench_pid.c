@@ -0,0 +1,205 @@
+/*
+ * @file bench_pid.c
+ *
+ * @brief Host benchmark of one pid controller update, comparing the
+ *		  fixed-point controller against the double precision controller
+ *		  it replaced. Both drive the same simulated lift, and the test
+ *		  fails if their outputs ever differ by more than one count.
+ *		  The reference truncates its output as the double controller
+ *		  did, while the fixed-point controller rounds, so the outputs
+ *		  may differ by one. The host has a floating point unit, so the
+ *		  gap here is far smaller than on the CORTEX, where every double
+ *		  operation is a software library call. The fixed-point update
+ *		  has no division, so it does not pay for the software 64 bit
+ *		  divide that fixed_div needs on the CORTEX.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <pid.h>
+#include <stdlib.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT "cycles"
+#else
+#define BENCH_UNIT "ns"
+#endif
+
+#define BENCH_UPDATES 1000000	//controller updates timed for each version
+#define BENCH_KP      0.7			//proportional gain
+#define BENCH_KI      0.01		//integral gain
+#define BENCH_KD      0.3			//derivative gain
+#define BENCH_FILTER  0.5			//derivative filter coefficient
+
+//double precision controller, the controller before it was moved to fixed-point
+struct{
+	double kP, kI, kD, dFilter, integralMax;
+	int outMin, outMax, target, lastValue, output;
+	double integral, derivative;
+	bool first, settled;
+	int direction, overshoot, settledCount;
+} typedef DoublePID;
+
+/*
+ * Read the time stamp counter, or the monotonic clock where there is
+ * no counter.
+ *
+ * @return The current time in BENCH_UNIT.
+ */
+static unsigned long long bench_now(){
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (unsigned long long)now.tv_sec * 1000000000ull + now.tv_nsec;
+#endif
+}
+
+/*
+ * Run one sample of the double precision controller.
+ *
+ * @param pid The controller being updated.
+ * @param value The current sensor value.
+ * @return The output of the controller.
+ */
+static __attribute__((noinline)) int bench_doubleUpdate(DoublePID* pid, int value){
+
+	int error = pid->target - value;	//error for this sample
+	int velocity = 0;									//sensor change since the last sample
+
+	//first sample has no previous value
+	if(pid->first){
+		pid->first = false;
+		pid->direction = error < 0 ? -1 : 1;
+	}
+	else
+		velocity = value - pid->lastValue;
+	pid->lastValue = value;
+
+	//accumulate and clamp the integral term
+	pid->integral += pid->kI * error;
+	if(pid->integral > pid->integralMax)
+		pid->integral = pid->integralMax;
+	else if(pid->integral < -pid->integralMax)
+		pid->integral = -pid->integralMax;
+
+	pid->derivative = pid->dFilter * pid->derivative - (1 - pid->dFilter) * pid->kD * velocity;
+
+	double output = pid->kP * error + pid->integral + pid->derivative;	//unclamped output
+
+	//clamp output
+	if(output > pid->outMax)
+		pid->output = pid->outMax;
+	else if(output < pid->outMin)
+		pid->output = pid->outMin;
+	else
+		pid->output = output;	//truncated, like the double controller was
+
+	//track how far the system has gone past the target
+	if(-error * pid->direction > pid->overshoot)
+		pid->overshoot = -error * pid->direction;
+
+	//same settle detection as the fixed-point controller
+	if(!pid->settled){
+		if(abs(error) <= PID_SETTLE_ERROR && abs(velocity) <= PID_SETTLE_VELOCITY)
+			pid->settledCount++;
+		else
+			pid->settledCount = 0;
+		pid->settled = pid->settledCount >= PID_SETTLE_SAMPLES;
+	}
+
+	return pid->output;
+}
+
+/*
+ * Run one sample of the fixed-point controller.
+ *
+ * @param pid The controller being updated.
+ * @param value The current sensor value.
+ * @return The output of the controller.
+ */
+static __attribute__((noinline)) int bench_fixedUpdate(PID* pid, int value){
+	return pid_update(pid, value);
+}
+
+/*
+ * Retrieve the target of the simulated lift for an update, moving
+ * between the bottom and the scoring height.
+ *
+ * @param i The update number.
+ * @return The target.
+ */
+static int bench_target(int i){
+	return (i / 200) % 2 ? 1985 : 0;
+}
+
+int main(){
+
+	PID fixedPID = pid_init(FIXED(BENCH_KP), FIXED(BENCH_KI), FIXED(BENCH_KD));	//controller under test
+	pid_setFilter(&fixedPID, FIXED(BENCH_FILTER));
+	pid_setTimeout(&fixedPID, 0);
+
+	DoublePID doublePID = {BENCH_KP, BENCH_KI, BENCH_KD, BENCH_FILTER, 127, -127, 127, 0, 0, 0, 0, 0, true, false, 1, 0, 0};	//reference controller
+
+	int lift = 0;					//position of the simulated lift
+	int worst = 0;				//largest difference between the outputs
+	volatile int sink;		//keeps the timed loops from being optimised away
+
+	//compare the outputs over the same moves
+	for(int i = 0; i < 20000; i++){
+		pid_setTarget(&fixedPID, bench_target(i));
+		if(doublePID.target != bench_target(i)){
+			doublePID.target = bench_target(i);
+			doublePID.integral = 0;
+			doublePID.derivative = 0;
+			doublePID.first = true;
+			doublePID.settled = false;
+			doublePID.settledCount = 0;
+			doublePID.overshoot = 0;
+		}
+
+		int a = bench_fixedUpdate(&fixedPID, lift);
+		int b = bench_doubleUpdate(&doublePID, lift);
+		lift += b / 8;	//both see the lift driven by the reference
+
+		//outputs differ
+		if(abs(a - b) > worst)
+			worst = abs(a - b);
+	}
+
+	//time the fixed-point controller
+	unsigned long long start = bench_now();
+	for(int i = 0; i < BENCH_UPDATES; i++)
+		sink = bench_fixedUpdate(&fixedPID, i & 2047);
+	unsigned long long fixedTime = bench_now() - start;
+
+	//time the double controller
+	start = bench_now();
+	for(int i = 0; i < BENCH_UPDATES; i++)
+		sink = bench_doubleUpdate(&doublePID, i & 2047);
+	unsigned long long doubleTime = bench_now() - start;
+
+	(void)sink;
+
+	printf("pid update: fixed %.1f %s, double %.1f %s, largest output difference %d\n",
+	       (double)fixedTime / BENCH_UPDATES, BENCH_UNIT, (double)doubleTime / BENCH_UPDATES, BENCH_UNIT, worst);
+	printf("pid update: no fixed_div per update, which is a software 64 bit divide on the CORTEX\n");
+
+	return worst <= 1 ? 0 : 1;
+}
@@ -0,0 +1,166 @@
+/*
+ * @file bench_trig.c
+ *
+ * @brief Host accuracy check and benchmark of the table driven
+ *		  trigonometry against libm. The worst errors over a sweep of
+ *		  each domain are checked against the bounds documented in
+ *		  trig.h, and the test fails if any is exceeded. The timings are
+ *		  for the host, which has a floating point unit and a hardware
+ *		  square root, so they understate the gap on the CORTEX, where
+ *		  every libm call runs in software.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <trig.h>
+#include <math.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT "cycles"
+#else
+#define BENCH_UNIT "ns"
+#endif
+
+#define BENCH_CALLS   1000000						//calls timed for each function
+#define BENCH_RADIANS (3.14159265358979 / 180)	//radians in a degree
+
+//documented worst case errors
+#define BOUND_SINE   6e-5		//sine and cosine
+#define BOUND_ATAN2  0.002		//atan2 in degrees
+#define BOUND_ROOT   7e-5		//relative square root error above 1
+#define BOUND_SMALL  3				//square root error below 1 in LSB
+
+static int failures;	//number of bounds exceeded
+
+/*
+ * Read the time stamp counter, or the monotonic clock where there is
+ * no counter.
+ *
+ * @return The current time in BENCH_UNIT.
+ */
+static unsigned long long bench_now(){
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (unsigned long long)now.tv_sec * 1000000000ull + now.tv_nsec;
+#endif
+}
+
+/*
+ * Report a worst case error and check it against its bound.
+ *
+ * @param name The name of the function.
+ * @param error The worst error measured.
+ * @param bound The documented bound.
+ */
+static void bench_bound(const char* name, double error, double bound){
+	printf("%s %s: worst error %.2g, bound %.2g\n", error <= bound ? "PASS" : "FAIL", name, error, bound);
+
+	//bound exceeded
+	if(error > bound)
+		failures++;
+}
+
+static __attribute__((noinline)) Fixed table_sin(Fixed angle){ return trig_sin(angle); }
+static __attribute__((noinline)) Fixed table_atan2(Fixed y, Fixed x){ return trig_atan2(y, x); }
+static __attribute__((noinline)) Fixed table_sqrt(Fixed value){ return trig_sqrt(value); }
+static __attribute__((noinline)) double libm_sin(double angle){ return sin(angle * BENCH_RADIANS); }
+static __attribute__((noinline)) double libm_atan2(double y, double x){ return atan2(y, x) / BENCH_RADIANS; }
+static __attribute__((noinline)) double libm_sqrt(double value){ return sqrt(value); }
+
+int main(){
+
+	double worst;	//worst error of the current sweep
+
+	//sine and cosine over two turns each way at 1/256 degree
+	worst = 0;
+	for(Fixed a = FIXED(-720); a <= FIXED(720); a += FIXED_ONE / 256){
+		double d = fixed_toDouble(a) * BENCH_RADIANS;
+		worst = fmax(worst, fabs(fixed_toDouble(trig_sin(a)) - sin(d)));
+		worst = fmax(worst, fabs(fixed_toDouble(trig_cos(a)) - cos(d)));
+	}
+	bench_bound("trig_sin, trig_cos", worst, BOUND_SINE);
+
+	//atan2 around circles of several sizes
+	worst = 0;
+	for(int r = 1; r <= 10000; r *= 10)
+		for(int i = 0; i < 36000; i++){
+			double d = i * 0.01 * BENCH_RADIANS;
+			Fixed x = fixed_fromDouble(r * cos(d));
+			Fixed y = fixed_fromDouble(r * sin(d));
+			double error = fabs(fixed_toDouble(trig_atan2(y, x)) - atan2(fixed_toDouble(y), fixed_toDouble(x)) / BENCH_RADIANS);
+			worst = fmax(worst, fmin(error, 360 - error));
+		}
+	bench_bound("trig_atan2", worst, BOUND_ATAN2);
+
+	//square root above 1, relative to the root
+	worst = 0;
+	for(Fixed v = FIXED_ONE; v > 0 && v < 0x7FFF0000; v += v / 4093 + 1)
+		worst = fmax(worst, fabs(fixed_toDouble(trig_sqrt(v)) - sqrt(fixed_toDouble(v))) / sqrt(fixed_toDouble(v)));
+	bench_bound("trig_sqrt above 1", worst, BOUND_ROOT);
+
+	//square root below 1, in LSB
+	worst = 0;
+	for(Fixed v = 1; v < FIXED_ONE; v++)
+		worst = fmax(worst, fabs(fixed_toDouble(trig_sqrt(v)) - sqrt(fixed_toDouble(v))) * FIXED_ONE);
+	bench_bound("trig_sqrt below 1", worst, BOUND_SMALL);
+
+	volatile Fixed fixedSink;		//keeps the timed loops from being optimised away
+	volatile double doubleSink;
+	unsigned long long start, table, libm;
+
+	//time sine
+	start = bench_now();
+	for(int i = 0; i < BENCH_CALLS; i++)
+		fixedSink = table_sin((i & 0xFFFFF) * 23);
+	table = bench_now() - start;
+	start = bench_now();
+	for(int i = 0; i < BENCH_CALLS; i++)
+		doubleSink = libm_sin((i & 0xFFFFF) * 23 / 65536.0);
+	libm = bench_now() - start;
+	printf("sin: table %.1f %s, libm %.1f %s\n", (double)table / BENCH_CALLS, BENCH_UNIT, (double)libm / BENCH_CALLS, BENCH_UNIT);
+
+	//time atan2
+	start = bench_now();
+	for(int i = 0; i < BENCH_CALLS; i++)
+		fixedSink = table_atan2((i & 1023) * 4099 - 2000000, (i >> 10) * 3001 - 1500000);
+	table = bench_now() - start;
+	start = bench_now();
+	for(int i = 0; i < BENCH_CALLS; i++)
+		doubleSink = libm_atan2(((i & 1023) * 4099 - 2000000) / 65536.0, ((i >> 10) * 3001 - 1500000) / 65536.0);
+	libm = bench_now() - start;
+	printf("atan2: table %.1f %s, libm %.1f %s\n", (double)table / BENCH_CALLS, BENCH_UNIT, (double)libm / BENCH_CALLS, BENCH_UNIT);
+
+	//time square root
+	start = bench_now();
+	for(int i = 0; i < BENCH_CALLS; i++)
+		fixedSink = table_sqrt(i * 2039 + 1);
+	table = bench_now() - start;
+	start = bench_now();
+	for(int i = 0; i < BENCH_CALLS; i++)
+		doubleSink = libm_sqrt((i * 2039 + 1) / 65536.0);
+	libm = bench_now() - start;
+	printf("sqrt: table %.1f %s, libm %.1f %s\n", (double)table / BENCH_CALLS, BENCH_UNIT, (double)libm / BENCH_CALLS, BENCH_UNIT);
+
+	(void)fixedSink;
+	(void)doubleSink;
+
+	return failures == 0 ? 0 : 1;
+}
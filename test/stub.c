@@ -0,0 +1,105 @@
+/*
+ * @file stub.c
+ *
+ * @brief Implementation of the host stand-ins for the PROS library.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "stub.h"
+
+static unsigned long stubTime;	//simulated time in milliseconds
+
+/*
+ * Set the simulated time.
+ *
+ * @param time The time in milliseconds.
+ */
+void stub_setTime(unsigned long time){
+	stubTime = time;
+}
+
+/*
+ * Move the simulated time forward.
+ *
+ * @param time The time to move forward in milliseconds.
+ */
+void stub_advance(unsigned long time){
+	stubTime += time;
+}
+
+/*
+ * Retrieve the simulated time.
+ *
+ * @return The time in milliseconds.
+ */
+unsigned long millis(){
+	return stubTime;
+}
+
+/*
+ * Retrieve the simulated time in microseconds.
+ *
+ * @return The time in microseconds.
+ */
+unsigned long micros(){
+	return stubTime * 1000;
+}
+
+/*
+ * Move the simulated time forward instead of waiting.
+ *
+ * @param time The time to wait in milliseconds.
+ */
+void delay(const unsigned long time){
+	stubTime += time;
+}
+
+/*
+ * Move the simulated time forward to the next wake time.
+ *
+ * @param previousWakeTime The last wake time, moved on by one cycle.
+ * @param cycleTime The cycle time in milliseconds.
+ */
+void taskDelayUntil(unsigned long* previousWakeTime, const unsigned long cycleTime){
+	*previousWakeTime += cycleTime;
+
+	//wake time is still ahead
+	if(stubTime < *previousWakeTime)
+		stubTime = *previousWakeTime;
+}
+
+/*
+ * Refuse to start a task. Tasks never run on the host, so modules fall
+ * back to being stepped directly.
+ *
+ * @param taskCode The task function.
+ * @param stackDepth The stack size of the task.
+ * @param parameters The task parameter.
+ * @param priority The priority of the task.
+ * @return NULL, since no task was created.
+ */
+TaskHandle taskCreate(TaskCode taskCode, const unsigned int stackDepth, void* parameters, const unsigned int priority){
+	return NULL;
+}
+
+/*
+ * Delete a task, which never exists on the host.
+ *
+ * @param taskToDelete The task being deleted.
+ */
+void taskDelete(TaskHandle taskToDelete){
+}
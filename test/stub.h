@@ -0,0 +1,33 @@
+/*
+ * @file stub.h
+ *
+ * @brief Host stand-ins for the parts of the PROS library the tested
+ *		  modules call. Time only moves when a test moves it, and tasks
+ *		  are never started, so a test drives each module by calling its
+ *		  step function.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STUB_H_
+#define STUB_H_
+
+#include <API.h>
+
+void stub_setTime(unsigned long time);	//set the time millis and micros report in milliseconds
+void stub_advance(unsigned long time);	//move the time forward in milliseconds
+
+#endif /* STUB_H_ */
@@ -0,0 +1,141 @@
+/*
+ * @file stub_io.c
+ *
+ * @brief Host stand-ins for the PROS hardware functions, so modules
+ *		  that reach the hardware can be linked on the host. Every input
+ *		  reads zero and every output is dropped. The time and task
+ *		  stand-ins are in stub.c.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "stub.h"
+
+/*
+ * Analog inputs read zero.
+ */
+int analogCalibrate(unsigned char channel){
+	return 0;
+}
+
+int analogRead(unsigned char channel){
+	return 0;
+}
+
+int analogReadCalibratedHR(unsigned char channel){
+	return 0;
+}
+
+/*
+ * Digital inputs read low, outputs and interrupts are dropped.
+ */
+bool digitalRead(unsigned char pin){
+	return false;
+}
+
+void digitalWrite(unsigned char pin, bool value){
+}
+
+void pinMode(unsigned char pin, unsigned char mode){
+}
+
+void ioSetInterrupt(unsigned char pin, unsigned char edges, InterruptHandler handler){
+}
+
+void ioClearInterrupt(unsigned char pin){
+}
+
+/*
+ * Encoders, gyros and range finders read zero.
+ */
+Encoder encoderInit(unsigned char portTop, unsigned char portBottom, bool reverse){
+	return NULL;
+}
+
+int encoderGet(Encoder enc){
+	return 0;
+}
+
+void encoderReset(Encoder enc){
+}
+
+void encoderShutdown(Encoder enc){
+}
+
+Gyro gyroInit(unsigned char port, unsigned short multiplier){
+	return NULL;
+}
+
+int gyroGet(Gyro gyro){
+	return 0;
+}
+
+void gyroReset(Gyro gyro){
+}
+
+void gyroShutdown(Gyro gyro){
+}
+
+Ultrasonic ultrasonicInit(unsigned char portEcho, unsigned char portPing){
+	return NULL;
+}
+
+int ultrasonicGet(Ultrasonic ult){
+	return 0;
+}
+
+void ultrasonicShutdown(Ultrasonic ult){
+}
+
+/*
+ * The IME chain is empty.
+ */
+unsigned int imeInitializeAll(){
+	return 0;
+}
+
+bool imeGet(unsigned char address, int* value){
+	*value = 0;
+	return false;
+}
+
+bool imeReset(unsigned char address){
+	return false;
+}
+
+/*
+ * Motor commands and lcd writes are dropped, the lcd has no buttons
+ * pressed and the battery is at the nominal 7.2 V.
+ */
+void motorSet(unsigned char channel, int speed){
+}
+
+void lcdInit(FILE* lcdPort){
+}
+
+unsigned int lcdReadButtons(FILE* lcdPort){
+	return 0;
+}
+
+void lcdSetBacklight(FILE* lcdPort, bool backlight){
+}
+
+void lcdSetText(FILE* lcdPort, unsigned char line, const char* buffer){
+}
+
+unsigned int powerLevelMain(){
+	return 7200;
+}
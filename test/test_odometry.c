@@ -0,0 +1,181 @@
+/*
+ * @file test_odometry.c
+ *
+ * @brief Host test of the odometry. A simulated differential drive
+ *		  turns known straights, arcs and spins into encoder and gyro
+ *		  counts, and the integrated pose is checked against the path
+ *		  the drive actually took.
+ *
+ * Copyright (C) 2016  Jordan M. Kieltyka
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <odometry.h>
+#include <math.h>
+#include "stub.h"
+
+#define TEST_TRACK  1000		//distance between the simulated wheels in encoder counts
+#define TEST_STEPS  500			//odometry steps each move is split into
+#define TEST_PI     3.14159265358979
+
+//simulated differential drive
+struct{
+	double left, right;		//exact wheel travel in encoder counts
+	double heading;				//exact heading in degrees
+	double gyroZero;			//heading the gyro reads zero at
+	double x, y;					//exact position in encoder counts
+} typedef Drive;
+
+static Drive drive;						//drive being simulated
+static Sensor sensors[3];			//left encoder, right encoder and gyro, told apart by id
+static int failures;					//number of failed checks
+
+/*
+ * Read a simulated sensor in place of the sampler. Encoders report
+ * whole counts and the gyro whole degrees, like the real sensors.
+ *
+ * @param target The sensor being read.
+ * @return The sensor value.
+ */
+int sensor_getValueRef(const Sensor* target){
+
+	//simulated sensor
+	switch(target->id){
+		case 0: return lround(drive.left);
+		case 1: return lround(drive.right);
+		default: return lround(drive.heading - drive.gyroZero);
+	}
+}
+
+/*
+ * Move the drive along an arc, stepping the odometry along the way. A
+ * radius of zero spins in place and an infinite radius drives straight.
+ *
+ * @param distance The travel of the middle of the drive in encoder counts, or the turn in degrees for a spin.
+ * @param radius The radius of the arc in encoder counts, positive to turn left.
+ */
+static void test_move(double distance, double radius){
+
+	//split the move into steps
+	for(int i = 0; i < TEST_STEPS; i++){
+		double turn;		//turn over the step in degrees
+		double travel;	//travel of the middle over the step
+
+		//spin in place
+		if(radius == 0){
+			turn = distance / TEST_STEPS;
+			travel = 0;
+		}
+
+		//straight or arc
+		else{
+			travel = distance / TEST_STEPS;
+			turn = isinf(radius) ? 0 : travel / radius * 180 / TEST_PI;
+		}
+
+		double wheel = turn * TEST_PI / 180 * TEST_TRACK / 2;	//wheel travel from the turn
+		double mid = (drive.heading + turn / 2) * TEST_PI / 180;	//heading halfway through the step
+
+		drive.left += travel - wheel;
+		drive.right += travel + wheel;
+		drive.x += travel * cos(mid);
+		drive.y += travel * sin(mid);
+		drive.heading += turn;
+
+		stub_advance(ODOMETRY_PERIOD);
+		odometry_step();
+	}
+}
+
+/*
+ * Check the integrated pose against the simulated drive.
+ *
+ * @param name The name of the check.
+ * @param position The largest position error allowed in encoder counts.
+ * @param heading The largest heading error allowed in degrees.
+ */
+static void test_check(const char* name, double position, double heading){
+
+	Pose pose = odometry_getPose();	//integrated pose
+	double x = fixed_toDouble(pose.x);
+	double y = fixed_toDouble(pose.y);
+	double h = fixed_toDouble(pose.heading);
+	bool good = fabs(x - drive.x) <= position && fabs(y - drive.y) <= position && fabs(h - drive.heading) <= heading;
+
+	printf("%s %s: pose (%.1f, %.1f, %.2f), drive (%.1f, %.1f, %.2f)\n", good ? "PASS" : "FAIL", name, x, y, h, drive.x, drive.y, drive.heading);
+
+	//pose is too far from the drive
+	if(!good)
+		failures++;
+}
+
+/*
+ * Put the drive and the odometry back at the origin.
+ *
+ * @param gyro If the odometry fuses the gyro.
+ */
+static void test_reset(bool gyro){
+	drive = (Drive){0, 0, 0, 0, 0, 0};
+	odometry_init(&sensors[0], &sensors[1], gyro ? &sensors[2] : NULL, TEST_TRACK);
+}
+
+int main(){
+
+	//tell the simulated sensors apart
+	for(int i = 0; i < 3; i++)
+		sensors[i].id = i;
+
+	//encoders only, then with the gyro fused in
+	for(int gyro = 0; gyro <= 1; gyro++){
+		const char* source = gyro ? "gyro" : "encoders";
+		printf("heading from the %s\n", source);
+
+		test_reset(gyro);
+		test_move(10000, INFINITY);
+		test_check("straight", 2, 0.01);
+
+		test_reset(gyro);
+		test_move(10000, -INFINITY);
+		test_move(-10000, INFINITY);
+		test_check("straight and back", 2, 0.01);
+
+		test_reset(gyro);
+		test_move(5000 * TEST_PI / 2, 5000);
+		test_check("quarter arc left", 20, 0.5);
+
+		test_reset(gyro);
+		test_move(3000 * TEST_PI, -3000);
+		test_check("half arc right", 20, 0.5);
+
+		test_reset(gyro);
+		test_move(360, 0);
+		test_check("spin", 2, 0.5);
+
+		test_reset(gyro);
+		test_move(4000, INFINITY);
+		test_move(90, 0);
+		test_move(4000, INFINITY);
+		test_move(2000 * TEST_PI / 2, 2000);
+		test_check("square and arc", 30, 0.5);
+
+		test_reset(gyro);
+		odometry_setPose(FIXED(100), FIXED(200), FIXED(90));
+		drive = (Drive){drive.left, drive.right, 90, 90, 100, 200};
+		test_move(3000, INFINITY);
+		test_check("straight from a set pose", 2, 0.01);
+	}
+
+	return failures == 0 ? 0 : 1;
+}
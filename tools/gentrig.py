@@ -0,0 +1,53 @@
+#!/usr/bin/env python
+#
+# Generate the fixed-point tables of the trigonometry in src/trig.c.
+#
+# Every entry is rounded to Q16.16:
+#
+#   trigSine[i]    sin(i degrees), i = 0 to 90
+#   trigArctan[i]  atan(i / 64) in degrees, i = 0 to 64
+#   trigRoot[i]    sqrt((i + 32) / 128), i = 0 to 96
+#
+# Usage: gentrig.py [output], writing to stdout without an output file.
+# The src Makefile runs this to build src/trig_tables.h.
+
+import math
+import sys
+
+ONE = 1 << 16	# fixed-point one
+
+def fixed(value):
+	"""Round a value to fixed-point."""
+	return int(math.floor(value * ONE + 0.5))
+
+def table(name, comment, values):
+	"""Format a const table, eight entries to a line."""
+	lines = ["//" + comment, "static const Fixed %s[%d] = {" % (name, len(values))]
+	for i in range(0, len(values), 8):
+		row = ", ".join(str(v) for v in values[i:i + 8])
+		lines.append("\t" + row + ("," if i + 8 < len(values) else ""))
+	lines.append("};")
+	return "\n".join(lines)
+
+def main():
+	sine = [fixed(math.sin(math.radians(i))) for i in range(91)]
+	arctan = [fixed(math.degrees(math.atan(i / 64.0))) for i in range(65)]
+	root = [fixed(math.sqrt((i + 32) / 128.0)) for i in range(97)]
+
+	text = "\n\n".join([
+		"/* Generated by tools/gentrig.py, do not edit. */",
+		"#ifndef TRIG_TABLES_H_\n#define TRIG_TABLES_H_",
+		table("trigSine", "sine of each whole degree from 0 to 90", sine),
+		table("trigArctan", "arctangent in degrees of each 64th from 0 to 1", arctan),
+		table("trigRoot", "square root of each 128th from 0.25 to 1", root),
+		"#endif /* TRIG_TABLES_H_ */\n"])
+
+	# write the tables
+	if len(sys.argv) > 1:
+		with open(sys.argv[1], "w") as out:
+			out.write(text)
+	else:
+		sys.stdout.write(text)
+
+if __name__ == "__main__":
+	main()